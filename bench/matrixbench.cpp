@@ -0,0 +1,305 @@
+/*
+Name of Program: EECS 348 Lab 9 benchmark
+Description: Times Matrix operations over a sweep of sizes, element types and thread counts, and writes the results as JSON
+Input: Command-line options (see --help)
+Output: Table of results on stderr, JSON on stdout or in the file given by --json
+Collaborators: None
+Sources: None
+Author: Oscar Ohly
+Creation date: 04/07/2025
+*/
+#include <algorithm> //gets sorting
+#include <chrono> //gets timers
+#include <cstdio> //gets file removal
+#include <fstream> //gets file writing
+#include <iomanip> //gets output formatting for the results table
+#include <iostream> //gets standard C++ library
+#include <sstream> //gets string streams for parsing lists
+#include <string> //gets string class
+#include <thread> //gets hardware thread count
+#include <vector> //gets vectors
+#include "matrix.h" //gets Matrix class and matrix operations
+
+struct BenchOptions { //settings read from the command line
+    std::vector<size_t> sizes; //matrix sizes to run
+    std::vector<size_t> threads; //thread counts to run
+    std::vector<std::string> types{"int", "double"}; //element types to run
+    std::vector<std::string> ops{"add", "multiply", "swapRows", "swapColumns", "diagonals", "load", "loadBinary"}; //operations to run
+    size_t maxLoadSize = 2048; //largest size for the load benchmarks, which write a temporary file
+    double minSeconds = 0.2; //minimum time spent timing one case
+    size_t minSamples = 3; //minimum samples per case
+    size_t maxSamples = 1000; //maximum samples per case
+    std::string jsonPath; //file for JSON output, stdout if empty
+    std::string tempDir = "/tmp"; //directory for load benchmark files
+}; //ends BenchOptions definition
+
+struct BenchResult { //timing summary of one case
+    std::string op; //operation name
+    std::string type; //element type name
+    size_t size = 0; //matrix size
+    size_t threads = 0; //thread count
+    size_t samples = 0; //number of timed samples
+    size_t callsPerSample = 0; //calls batched into each sample so fast operations are measurable
+    double minNs = 0, meanNs = 0, p50Ns = 0, p90Ns = 0, p99Ns = 0, maxNs = 0; //per-call times in nanoseconds
+    double flops = 0; //floating point or integer operations per call
+    double bytes = 0; //bytes touched per call
+}; //ends BenchResult definition
+
+std::vector<size_t> parseList(const std::string& text) { //function parses a comma separated list of numbers
+    std::vector<size_t> values; //parsed values
+    std::stringstream stream(text); //reads text
+    std::string item; //one entry
+    while (std::getline(stream, item, ',')) { //runs for each entry
+        values.push_back(std::stoul(item)); //parses entry
+    } //ends while loop
+    return values; //returns values
+} //ends function
+
+std::vector<std::string> parseNames(const std::string& text) { //function parses a comma separated list of names
+    std::vector<std::string> names; //parsed names
+    std::stringstream stream(text); //reads text
+    std::string item; //one entry
+    while (std::getline(stream, item, ',')) { //runs for each entry
+        names.push_back(item); //keeps entry
+    } //ends while loop
+    return names; //returns names
+} //ends function
+
+double percentile(const std::vector<double>& sorted, double fraction) { //function returns nearest-rank percentile of sorted samples
+    const size_t rank = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5); //index of percentile
+    return sorted[std::min(rank, sorted.size() - 1)]; //returns sample
+} //ends function
+
+template <typename F> //declares template for the timed callable F
+BenchResult timeCase(F&& body, const BenchOptions& options) { //function times body and summarizes per-call times
+    using Clock = std::chrono::steady_clock; //monotonic clock
+    body(); //warm-up call, faults in pages and fills caches
+    size_t calls = 1; //calls per sample
+    while (true) { //grows batch until one sample takes at least 20 microseconds
+        const Clock::time_point start = Clock::now(); //start of batch
+        for (size_t i = 0; i < calls; ++i) { //runs batch
+            body(); //timed call
+        } //ends for loop
+        if (Clock::now() - start >= std::chrono::microseconds(20) || calls >= (size_t(1) << 20)) { //runs if batch is long enough to time
+            break; //keeps batch size
+        } //ends if statement
+        calls *= 2; //doubles batch
+    } //ends while loop
+    std::vector<double> samples; //per-call times
+    const Clock::time_point caseStart = Clock::now(); //start of timing
+    while (samples.size() < options.maxSamples && (samples.size() < options.minSamples || std::chrono::duration<double>(Clock::now() - caseStart).count() < options.minSeconds)) { //runs until enough samples and time
+        const Clock::time_point start = Clock::now(); //start of sample
+        for (size_t i = 0; i < calls; ++i) { //runs batch
+            body(); //timed call
+        } //ends for loop
+        samples.push_back(std::chrono::duration<double, std::nano>(Clock::now() - start).count() / calls); //per-call time
+    } //ends while loop
+    std::sort(samples.begin(), samples.end()); //sorts for percentiles
+    BenchResult result; //summary
+    result.samples = samples.size(); //number of samples
+    result.callsPerSample = calls; //batch size
+    result.minNs = samples.front(); //fastest sample
+    result.maxNs = samples.back(); //slowest sample
+    double total = 0; //sum of samples
+    for (double sample : samples) { //runs for each sample
+        total += sample; //adds sample
+    } //ends for loop
+    result.meanNs = total / samples.size(); //mean sample
+    result.p50Ns = percentile(samples, 0.50); //median
+    result.p90Ns = percentile(samples, 0.90); //90th percentile
+    result.p99Ns = percentile(samples, 0.99); //99th percentile
+    return result; //returns summary
+} //ends function
+
+template <typename T> //declares template for a generic type T
+Matrix<T> benchMatrix(size_t n, unsigned seed) { //function fills a matrix with small values so int products do not overflow
+    Matrix<T> matrix(n); //new matrix
+    unsigned state = seed; //simple linear congruential generator state
+    for (size_t i = 0; i < n; ++i) { //runs for size of matrix
+        for (size_t j = 0; j < n; ++j) { //runs for size of matrix
+            state = state * 1103515245u + 12345u; //next random number
+            matrix(i, j) = static_cast<T>(static_cast<int>((state >> 16) % 7) - 3); //value from -3 to 3
+        } //ends for loop
+    } //ends for loop
+    return matrix; //returns matrix
+} //ends function
+
+template <typename T> //declares template for a generic type T
+std::string writeTextFile(const Matrix<T>& matrix1, const Matrix<T>& matrix2, const std::string& path) { //function writes two matrices in matrixfile.txt format
+    std::ofstream file(path); //opens file
+    if (!file.is_open()) { //checks if file opens
+        throw std::runtime_error("Failed to open file"); //throws error
+    } //ends if statement
+    file << matrix1.getSize() << " " << (std::is_same<T, int>::value ? 0 : 1) << "\n"; //header
+    for (const Matrix<T>* matrix : {&matrix1, &matrix2}) { //runs for each matrix
+        for (size_t i = 0; i < matrix->getSize(); ++i) { //runs for size of matrix
+            for (size_t j = 0; j < matrix->getSize(); ++j) { //runs for size of matrix
+                file << (*matrix)(i, j) << (j + 1 < matrix->getSize() ? ' ' : '\n'); //writes value
+            } //ends for loop
+        } //ends for loop
+    } //ends for loop
+    return path; //returns path written
+} //ends function
+
+template <typename T> //declares template for a generic type T
+void runType(const std::string& typeName, size_t n, size_t threads, const BenchOptions& options, std::vector<BenchResult>& results) { //function runs every requested operation for one type, size and thread count
+    const Matrix<T> a = benchMatrix<T>(n, 1); //left operand
+    const Matrix<T> b = benchMatrix<T>(n, 2); //right operand
+    Matrix<T> c(n); //destination, reused by every call
+    Matrix<T> mutated = a; //matrix changed by the mutators
+    const double element = sizeof(T); //bytes per element
+    const double nn = static_cast<double>(n) * n; //elements per matrix
+    volatile double sink = 0; //keeps results from being optimized away
+    for (const std::string& op : options.ops) { //runs for each operation
+        BenchResult result; //summary of this case
+        if (op == "add") { //runs for addition
+            result = timeCase([&] { c = a + b; }, options); //fused addition into c
+            result.flops = nn; //one add per element
+            result.bytes = 3 * nn * element; //two reads and one write per element
+        } else if (op == "multiply") { //runs for multiplication
+            result = timeCase([&] { c = a * b; }, options); //blocked multiply into c
+            result.flops = 2 * nn * n; //one multiply and one add per inner step
+            result.bytes = 3 * nn * element; //each matrix touched at least once
+        } else if (op == "strassen") { //runs for Strassen multiplication
+            setMultiplyMode(MultiplyMode::Strassen); //switches algorithm for this case
+            result = timeCase([&] { c = a * b; }, options); //recursive multiply into c
+            setMultiplyMode(MultiplyMode::Blocked); //puts default algorithm back
+            result.flops = 2 * nn * n; //counted as the classical multiply so rates compare directly
+            result.bytes = 3 * nn * element; //each matrix touched at least once
+        } else if (op == "swapRows") { //runs for row swaps
+            result = timeCase([&] { mutated.swapRows(0, n - 1); }, options); //swaps row index entries
+            result.bytes = 2 * sizeof(size_t); //two index entries
+        } else if (op == "swapColumns") { //runs for column swaps
+            result = timeCase([&] { mutated.swapColumns(0, n - 1); }, options); //swaps one element per row
+            result.bytes = 4 * n * element; //two reads and two writes per row
+        } else if (op == "diagonals") { //runs for diagonal sums
+            result = timeCase([&] { sink = sink + static_cast<double>(a.sumMainDiagonal() + a.sumSecondaryDiagonal()); }, options); //both sums
+            result.flops = 2 * static_cast<double>(n); //one add per diagonal element
+            result.bytes = 2 * n * element; //one read per diagonal element
+        } else if (op == "load" || op == "loadBinary") { //runs for file loading
+            if (n > options.maxLoadSize) { //runs if file would be too large to write quickly
+                continue; //skips case
+            } //ends if statement
+            const std::string base = options.tempDir + "/matrixbench_" + std::to_string(::getpid()) + "_" + typeName + "_" + std::to_string(n); //temporary file name
+            const std::string text = writeTextFile(a, b, base + ".txt"); //text input
+            std::string path = text; //file being loaded
+            if (op == "loadBinary") { //runs for binary format
+                path = base + ".bin"; //binary input
+                convertTextToBinary(text, path); //writes binary file
+            } //ends if statement
+            Matrix<T> loaded1, loaded2; //loaded matrices
+            result = timeCase([&] { loadMatricesFromFile(path, loaded1, loaded2); }, options); //loads both matrices
+            result.bytes = static_cast<double>(MappedFile(path).getSize()); //bytes in file
+            std::remove(text.c_str()); //deletes text file
+            if (path != text) { //runs if binary file was written
+                std::remove(path.c_str()); //deletes binary file
+            } //ends if statement
+        } else { //runs for unknown operation names
+            throw std::invalid_argument("Unknown operation: " + op); //throws error
+        } //ends if statement
+        result.op = op; //operation name
+        result.type = typeName; //element type name
+        result.size = n; //matrix size
+        result.threads = threads; //thread count
+        results.push_back(result); //keeps result
+        std::cerr << std::left << std::setw(12) << op << std::setw(8) << typeName << std::right << std::setw(6) << n << std::setw(5) << threads //prints case
+                  << std::setw(14) << std::fixed << std::setprecision(0) << result.p50Ns << " ns" //median time
+                  << std::setw(10) << std::setprecision(2) << (result.flops > 0 ? result.flops / result.p50Ns : 0.0) << " GFLOP/s" //throughput
+                  << std::setw(10) << std::setprecision(2) << result.bytes / result.p50Ns << " GB/s\n"; //bandwidth
+    } //ends for loop
+} //ends function
+
+void writeJson(std::ostream& out, const std::vector<BenchResult>& results) { //function writes results as JSON, one case per line so diffs stay readable
+    const char* simd = activeSimdLevel() == SimdLevel::Avx512 ? "avx512" : activeSimdLevel() == SimdLevel::Avx2 ? "avx2" : "portable"; //kernel in use
+    out << "{\n  \"context\": {\"simd\": \"" << simd << "\", \"hardware_threads\": " << std::thread::hardware_concurrency() << "},\n  \"benchmarks\": [\n"; //header
+    out << std::setprecision(6) << std::defaultfloat; //enough digits for timings
+    for (size_t i = 0; i < results.size(); ++i) { //runs for each result
+        const BenchResult& r = results[i]; //result being written
+        const double seconds = r.p50Ns * 1e-9; //median time in seconds
+        out << "    {\"op\": \"" << r.op << "\", \"type\": \"" << r.type << "\", \"size\": " << r.size << ", \"threads\": " << r.threads //case
+            << ", \"samples\": " << r.samples << ", \"calls_per_sample\": " << r.callsPerSample //sampling
+            << ", \"min_ns\": " << r.minNs << ", \"mean_ns\": " << r.meanNs << ", \"p50_ns\": " << r.p50Ns << ", \"p90_ns\": " << r.p90Ns //times
+            << ", \"p99_ns\": " << r.p99Ns << ", \"max_ns\": " << r.maxNs //tail times
+            << ", \"gflops\": " << (r.flops > 0 ? r.flops / seconds * 1e-9 : 0.0) << ", \"bytes_per_second\": " << r.bytes / seconds << "}" //throughput
+            << (i + 1 < results.size() ? ",\n" : "\n"); //separator
+    } //ends for loop
+    out << "  ]\n}\n"; //footer
+} //ends function
+
+int main(int argc, char* argv[]) { //func main that runs when program is executed
+    try { //try block that runs if code doesn't error
+        BenchOptions options; //settings
+        size_t minSize = 16, maxSize = 8192; //default sweep range
+        for (int i = 1; i < argc; ++i) { //runs for each argument
+            const std::string arg(argv[i]); //argument
+            const bool hasValue = i + 1 < argc; //checks if a value follows
+            if (arg == "--sizes" && hasValue) { //explicit size list
+                options.sizes = parseList(argv[++i]); //parses sizes
+            } else if (arg == "--min-size" && hasValue) { //smallest size in sweep
+                minSize = std::stoul(argv[++i]); //parses size
+            } else if (arg == "--max-size" && hasValue) { //largest size in sweep
+                maxSize = std::stoul(argv[++i]); //parses size
+            } else if (arg == "--threads" && hasValue) { //thread counts
+                options.threads = parseList(argv[++i]); //parses counts
+            } else if (arg == "--types" && hasValue) { //element types
+                options.types = parseNames(argv[++i]); //parses names
+            } else if (arg == "--ops" && hasValue) { //operations
+                options.ops = parseNames(argv[++i]); //parses names
+            } else if (arg == "--max-load-size" && hasValue) { //largest load benchmark
+                options.maxLoadSize = std::stoul(argv[++i]); //parses size
+            } else if (arg == "--min-time" && hasValue) { //time per case
+                options.minSeconds = std::stod(argv[++i]); //parses seconds
+            } else if (arg == "--json" && hasValue) { //JSON output file
+                options.jsonPath = argv[++i]; //keeps path
+            } else if (arg == "--temp-dir" && hasValue) { //directory for load files
+                options.tempDir = argv[++i]; //keeps path
+            } else { //runs for --help and unknown options
+                std::cerr << "Usage: " << argv[0] << " [--sizes a,b,...] [--min-size N] [--max-size N] [--threads a,b,...]\n" //prints usage
+                          << "       [--types int,double] [--ops add,multiply,strassen,swapRows,swapColumns,diagonals,load,loadBinary]\n"
+                          << "       [--max-load-size N] [--min-time seconds] [--json file] [--temp-dir dir]\n";
+                return arg == "--help" ? 0 : 1; //help is not an error
+            } //ends if statement
+        } //ends for loop
+        if (options.sizes.empty()) { //runs if no explicit sizes were given
+            for (size_t n = minSize; n <= maxSize; n *= 2) { //powers of two from minSize to maxSize
+                options.sizes.push_back(n); //adds size
+            } //ends for loop
+        } //ends if statement
+        if (options.threads.empty()) { //runs if no thread counts were given
+            options.threads.push_back(1); //single thread
+            if (defaultThreadCount() > 1) { //runs if more threads are available
+                options.threads.push_back(defaultThreadCount()); //all threads
+            } //ends if statement
+        } //ends if statement
+
+        std::vector<BenchResult> results; //every case
+        for (size_t threads : options.threads) { //runs for each thread count
+            setMatrixThreadCount(threads); //resizes pool
+            for (const std::string& type : options.types) { //runs for each element type
+                for (size_t n : options.sizes) { //runs for each size
+                    if (type == "int") { //runs for int matrices
+                        runType<int>(type, n, threads, options, results); //times int operations
+                    } else if (type == "double") { //runs for double matrices
+                        runType<double>(type, n, threads, options, results); //times double operations
+                    } else { //runs for unknown types
+                        throw std::invalid_argument("Unknown type: " + type); //throws error
+                    } //ends if statement
+                } //ends for loop
+            } //ends for loop
+        } //ends for loop
+
+        if (options.jsonPath.empty()) { //runs if JSON goes to stdout
+            writeJson(std::cout, results); //writes JSON
+        } else { //runs if JSON goes to a file
+            std::ofstream file(options.jsonPath); //opens file
+            if (!file.is_open()) { //checks if file opens
+                throw std::runtime_error("Failed to open file"); //throws error
+            } //ends if statement
+            writeJson(file, results); //writes JSON
+        } //ends if statement
+    } catch (const std::exception& e) { //runs if try block failed
+        std::cerr << "Error: " << e.what() << std::endl; //prints error message
+        return 1; //nonzero exit on failure
+    } //ends catch block
+    return 0; //default return value for main
+} //ends main
@@ -0,0 +1,3084 @@
+/*
+Name of Program: EECS 348 Lab 9
+Description: Matrix class, multiplication kernels, thread pool and file loaders shared by matrixprog and matrixbench
+Input: None, included by other source files
+Output: None
+Collaborators: None
+Sources: DeepSeek
+Author: Oscar Ohly
+Creation date: 04/07/2025
+*/
+#ifndef MATRIX_H //include guard so the header is only read once
+#define MATRIX_H //marks header as included
+
+#include <iostream> //gets standard C++ library
+#include <fstream> //gets file reading capabilities
+#include <vector> //gets vector functions used to make matrices
+#include <iomanip> //gets input/output formatting functions
+#include <stdexcept> //gets exception library
+#include <typeinfo> //gets type information
+#include <limits> //gets numeric limits operations
+#include <new> //gets aligned operator new
+#include <algorithm> //gets min/max functions
+#include <cstdlib> //gets environment variable access
+#include <string> //gets string class
+#include <type_traits> //gets compile-time type checks
+#include <thread> //gets worker threads
+#include <mutex> //gets locks for the thread pool
+#include <condition_variable> //gets sleeping and waking for the thread pool
+#include <atomic> //gets lock-free counters
+#include <deque> //gets double-ended queues for work stealing
+#include <functional> //gets type-erased tasks
+#include <memory> //gets smart pointers
+#include <exception> //gets exception forwarding between threads
+#include <charconv> //gets locale-free number parsing
+#include <fcntl.h> //gets file opening for memory mapping
+#include <sys/mman.h> //gets memory mapping
+#include <sys/stat.h> //gets file sizes
+#include <unistd.h> //gets file closing
+#include <cstdint> //gets fixed-width integers for the binary format
+#include <cstring> //gets byte copies and comparisons
+#include <tuple> //gets row, col, value entries for sparse matrices
+#include <initializer_list> //gets lists of target blocks for Strassen
+#include <unordered_map> //gets size classes for the buffer pool
+#include <chrono> //gets wall clock timing for the profiler
+#include <array> //gets inline storage for fixed-size matrices
+#include <utility> //gets index sequences for unrolled fixed-size arithmetic
+#include <future> //gets background tile reads and writes for out-of-core multiply
+#ifdef __linux__ //hardware counters are Linux only
+#include <linux/perf_event.h> //gets perf_event_open event descriptions
+#include <sys/syscall.h> //gets perf_event_open system call number
+#endif //ends preprocessor check
+#if defined(__x86_64__) || defined(__i386__) //only x86 builds have SIMD intrinsics
+#include <immintrin.h> //gets AVX2/AVX-512 intrinsics
+#endif //ends preprocessor check
+
+template <typename T> //declares template for a generic type T
+struct AlignedAllocator { //allocator that hands out cache-line aligned blocks for matrix storage
+    using value_type = T; //type of element being allocated
+    static constexpr size_t alignment = 64; //alignment in bytes, one cache line
+
+    AlignedAllocator() noexcept = default; //default constructor
+    template <typename U> //declares template for rebinding to another type U
+    AlignedAllocator(const AlignedAllocator<U>&) noexcept {} //converting constructor used by containers
+
+    T* allocate(size_t count) { //allocates aligned storage for count elements
+        return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(alignment))); //aligned operator new
+    } //ends function
+
+    void deallocate(T* pointer, size_t) noexcept { //releases storage returned by allocate
+        ::operator delete(pointer, std::align_val_t(alignment)); //aligned operator delete
+    } //ends function
+
+    template <typename U> //declares template for comparing with another type U
+    bool operator==(const AlignedAllocator<U>&) const noexcept { return true; } //allocators are stateless so always equal
+    template <typename U> //declares template for comparing with another type U
+    bool operator!=(const AlignedAllocator<U>&) const noexcept { return false; } //allocators are stateless so never unequal
+}; //ends AlignedAllocator definition
+
+struct MatrixPoolStats { //counters for the matrix buffer pool
+    size_t hits = 0; //allocations served from a cached buffer
+    size_t misses = 0; //allocations that went to operator new
+    size_t releases = 0; //freed buffers handed back to the system because the pool was full
+    size_t cachedBlocks = 0; //buffers waiting for reuse
+    size_t cachedBytes = 0; //bytes waiting for reuse
+    size_t peakCachedBytes = 0; //most bytes ever waiting for reuse
+}; //ends MatrixPoolStats definition
+
+class MatrixBufferPool { //process-wide cache of freed matrix buffers, sorted into size classes so same-size results reuse storage
+private: //private members only accessible within MatrixBufferPool class
+    std::mutex lock; //guards everything below, buffers are large so contention is low
+    std::unordered_map<size_t, std::vector<void*> > freeBlocks; //cached buffers for each size class in bytes
+    size_t limit; //most bytes kept cached, larger frees go straight back to the system
+    MatrixPoolStats stats; //counters
+
+    static size_t defaultLimit() { //function reads MATRIX_POOL_MB, an eighth of physical memory but at least 256 MiB if unset
+        const char* requested = std::getenv("MATRIX_POOL_MB"); //optional override from environment
+        if (requested != nullptr) { //runs if override is set
+            const long megabytes = std::strtol(requested, nullptr, 10); //parses limit
+            if (megabytes >= 0) { //runs if limit is usable, 0 turns caching off
+                return static_cast<size_t>(megabytes) << 20; //converts to bytes
+            } //ends if statement
+        } //ends if statement
+        const long pages = ::sysconf(_SC_PHYS_PAGES); //physical memory in pages, -1 if unknown
+        const long pageSize = ::sysconf(_SC_PAGESIZE); //bytes per page
+        const size_t physical = pages > 0 && pageSize > 0 ? static_cast<size_t>(pages) * static_cast<size_t>(pageSize) : 0; //physical memory in bytes
+        return std::max(size_t(256) << 20, physical / 8); //scales with the machine, so an 8192 x 8192 double result (512 MiB) is cached on boxes with 4 GiB or more
+    } //ends function
+
+    void releaseAll() { //frees every cached buffer, lock must be held
+        for (auto& entry : freeBlocks) { //runs for each size class
+            for (void* block : entry.second) { //runs for each cached buffer
+                ::operator delete(block, std::align_val_t(AlignedAllocator<char>::alignment)); //returns buffer to system
+            } //ends for loop
+        } //ends for loop
+        freeBlocks.clear(); //forgets buffers
+        stats.cachedBlocks = 0; //nothing cached
+        stats.cachedBytes = 0; //nothing cached
+    } //ends function
+
+public: //public functions available outside class definition
+    MatrixBufferPool() : limit(defaultLimit()) {} //creates empty pool
+
+    static size_t sizeClass(size_t bytes) { //function rounds a request up to its size class, at most 25% larger above 4 KiB
+        if (bytes <= 4096) { //runs for small buffers
+            return (bytes + 63) / 64 * 64; //whole cache lines
+        } //ends if statement
+        size_t step = 1024; //quarter of the power of two below bytes
+        while (step * 8 < bytes) { //runs until bytes is between 4 and 8 steps
+            step *= 2; //doubles step
+        } //ends while loop
+        return (bytes + step - 1) / step * step; //rounds up to a whole step
+    } //ends function
+
+    void* allocate(size_t bytes) { //function returns a 64-byte aligned buffer of at least bytes
+        const size_t rounded = sizeClass(bytes); //size class of request
+        {
+            std::lock_guard<std::mutex> guard(lock); //locks pool
+            auto found = freeBlocks.find(rounded); //cached buffers of this class
+            if (found != freeBlocks.end() && !found->second.empty()) { //runs if one can be reused
+                void* block = found->second.back(); //takes most recently freed buffer, likely still in cache
+                found->second.pop_back(); //removes it from pool
+                ++stats.hits; //counts reuse
+                --stats.cachedBlocks; //one fewer cached
+                stats.cachedBytes -= rounded; //fewer bytes cached
+                return block; //returns reused buffer
+            } //ends if statement
+            ++stats.misses; //counts new allocation
+        } //ends lock scope
+        return ::operator new(rounded, std::align_val_t(AlignedAllocator<char>::alignment)); //new buffer, sized to its class so it can be reused
+    } //ends function
+
+    void deallocate(void* block, size_t bytes) noexcept { //function caches a buffer from allocate, or frees it if the pool is full
+        const size_t rounded = sizeClass(bytes); //size class of buffer
+        {
+            std::lock_guard<std::mutex> guard(lock); //locks pool
+            if (stats.cachedBytes + rounded <= limit) { //runs if buffer fits under the limit
+                try { //growing the free list can fail
+                    freeBlocks[rounded].push_back(block); //caches buffer
+                    ++stats.cachedBlocks; //one more cached
+                    stats.cachedBytes += rounded; //more bytes cached
+                    stats.peakCachedBytes = std::max(stats.peakCachedBytes, stats.cachedBytes); //tracks high water mark
+                    return; //buffer kept
+                } catch (const std::bad_alloc&) { //runs if free list could not grow
+                } //ends try block
+            } //ends if statement
+            ++stats.releases; //counts buffer given back
+        } //ends lock scope
+        ::operator delete(block, std::align_val_t(AlignedAllocator<char>::alignment)); //returns buffer to system
+    } //ends function
+
+    MatrixPoolStats getStats() { //function returns a copy of the counters
+        std::lock_guard<std::mutex> guard(lock); //locks pool
+        return stats; //returns counters
+    } //ends function
+
+    void resetStats() { //function zeros hit, miss and release counts, cached sizes are kept
+        std::lock_guard<std::mutex> guard(lock); //locks pool
+        stats.hits = stats.misses = stats.releases = 0; //zeros counters
+        stats.peakCachedBytes = stats.cachedBytes; //restarts high water mark
+    } //ends function
+
+    void trim() { //function frees every cached buffer
+        std::lock_guard<std::mutex> guard(lock); //locks pool
+        releaseAll(); //frees buffers
+    } //ends function
+
+    void setLimit(size_t bytes) { //function sets the most bytes kept cached, freeing everything if the cache is over it
+        std::lock_guard<std::mutex> guard(lock); //locks pool
+        limit = bytes; //stores limit
+        if (stats.cachedBytes > limit) { //runs if cache is already too large
+            releaseAll(); //frees buffers
+        } //ends if statement
+    } //ends function
+}; //ends MatrixBufferPool class definition
+
+inline MatrixBufferPool& matrixBufferPool() { //function returns the pool shared by all matrices
+    static MatrixBufferPool* pool = new MatrixBufferPool(); //never destroyed, so matrices in other static objects can still free into it at exit
+    return *pool; //returns pool
+} //ends function
+
+inline MatrixPoolStats getMatrixPoolStats() { return matrixBufferPool().getStats(); } //function returns pool hit, miss and size counters
+inline void resetMatrixPoolStats() { matrixBufferPool().resetStats(); } //function zeros pool hit, miss and release counters
+inline void trimMatrixPool() { matrixBufferPool().trim(); } //function frees every cached buffer
+inline void setMatrixPoolLimit(size_t bytes) { matrixBufferPool().setLimit(bytes); } //function sets the most bytes the pool keeps, 0 turns caching off
+
+template <typename T> //declares template for a generic type T
+struct PooledAllocator { //allocator that takes cache-line aligned blocks from the shared matrix buffer pool
+    using value_type = T; //type of element being allocated
+
+    PooledAllocator() noexcept = default; //default constructor
+    template <typename U> //declares template for rebinding to another type U
+    PooledAllocator(const PooledAllocator<U>&) noexcept {} //converting constructor used by containers
+
+    T* allocate(size_t count) { //takes storage for count elements from the pool
+        return static_cast<T*>(matrixBufferPool().allocate(count * sizeof(T))); //pooled aligned buffer
+    } //ends function
+
+    void deallocate(T* pointer, size_t count) noexcept { //gives storage back to the pool
+        matrixBufferPool().deallocate(pointer, count * sizeof(T)); //caches buffer for the next matrix of this size
+    } //ends function
+
+    template <typename U> //declares template for comparing with another type U
+    bool operator==(const PooledAllocator<U>&) const noexcept { return true; } //allocators share one pool so always equal
+    template <typename U> //declares template for comparing with another type U
+    bool operator!=(const PooledAllocator<U>&) const noexcept { return false; } //allocators share one pool so never unequal
+}; //ends PooledAllocator definition
+
+enum class MatrixOp { Multiply, Add, Scale, Load, Display, SwapRows, SwapColumns, Update, Count }; //operations the profiler keeps counters for
+
+inline const char* matrixOpName(MatrixOp op) { //function returns the name used for an operation in profile output
+    static const char* const names[] = {"multiply", "add", "scale", "load", "display", "swapRows", "swapColumns", "update"}; //one per MatrixOp
+    return names[static_cast<size_t>(op)]; //returns name
+} //ends function
+
+struct MatrixOpStats { //totals for one operation since the last reset
+    uint64_t calls = 0; //number of calls
+    uint64_t nanoseconds = 0; //wall time inside the calls
+    uint64_t bytes = 0; //bytes of matrix data read and written
+    uint64_t flops = 0; //arithmetic operations, adds and multiplies counted separately
+    uint64_t cycles = 0; //CPU cycles on the calling thread, 0 without hardware counters
+    uint64_t instructions = 0; //instructions retired on the calling thread, 0 without hardware counters
+    uint64_t cacheMisses = 0; //last-level cache misses on the calling thread, 0 without hardware counters
+}; //ends MatrixOpStats definition
+
+class HardwareCounters { //cycle, instruction and cache miss counters for the calling thread, through perf_event_open on Linux
+private: //private members only accessible within HardwareCounters class
+    int fds[3] = {-1, -1, -1}; //cycles, instructions, cache misses
+    bool available = false; //true if all three counters opened
+
+public: //public functions available outside class definition
+    HardwareCounters() { //opens counters, leaves them unavailable if the kernel or container refuses
+#ifdef __linux__ //perf_event_open only exists on Linux
+        const uint64_t configs[3] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES}; //events to count
+        available = true; //becomes false if any counter fails
+        for (size_t i = 0; i < 3 && available; ++i) { //runs for each counter
+            perf_event_attr attr; //event description
+            std::memset(&attr, 0, sizeof(attr)); //zeros unused fields
+            attr.size = sizeof(attr); //struct version
+            attr.type = PERF_TYPE_HARDWARE; //generic hardware event
+            attr.config = configs[i]; //which event
+            attr.exclude_kernel = 1; //user space only, allowed at the default paranoid level
+            attr.exclude_hv = 1; //no hypervisor time
+            fds[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0)); //counts this thread on any CPU
+            available = fds[i] >= 0; //checks if counter opened
+        } //ends for loop
+#endif //ends preprocessor check
+    } //ends constructor
+
+    ~HardwareCounters() { //closes counters
+        for (int fd : fds) { //runs for each counter
+            if (fd >= 0) { //runs if counter was opened
+                ::close(fd); //closes counter
+            } //ends if statement
+        } //ends for loop
+    } //ends destructor
+
+    HardwareCounters(const HardwareCounters&) = delete; //counters own file descriptors
+    HardwareCounters& operator=(const HardwareCounters&) = delete; //counters own file descriptors
+
+    bool isAvailable() const { return available; } //function checks if counters can be read
+
+    bool read(uint64_t values[3]) const { //function reads cycles, instructions and cache misses, false if unavailable
+        if (!available) { //runs if counters did not open
+            return false; //nothing to read
+        } //ends if statement
+        for (size_t i = 0; i < 3; ++i) { //runs for each counter
+            if (::read(fds[i], &values[i], sizeof(uint64_t)) != static_cast<ssize_t>(sizeof(uint64_t))) { //reads counter
+                return false; //read failed
+            } //ends if statement
+        } //ends for loop
+        return true; //all counters read
+    } //ends function
+
+    static const HardwareCounters& forThisThread() { //function returns the counters of the calling thread, opened on first use
+        static thread_local HardwareCounters counters; //one set per thread
+        return counters; //returns counters
+    } //ends function
+}; //ends HardwareCounters class definition
+
+class MatrixProfiler { //process-wide operation counters, updated by MATRIX_PROFILE_SCOPE when built with MATRIX_ENABLE_PROFILING
+private: //private members only accessible within MatrixProfiler class
+    struct Counters { //atomic totals for one operation
+        std::atomic<uint64_t> calls{0}, nanoseconds{0}, bytes{0}, flops{0}, cycles{0}, instructions{0}, cacheMisses{0}; //see MatrixOpStats
+    }; //ends Counters definition
+
+    Counters counters[static_cast<size_t>(MatrixOp::Count)]; //one set per operation
+    std::atomic<bool> enabled{false}; //true if calls are being recorded
+    std::atomic<bool> hardware{false}; //true if hardware counters are read around each call
+    std::mutex dumpLock; //guards dumpPath
+    std::string dumpPath; //where the profile is written at exit, empty for nowhere
+
+    static void dumpAtExit() { //function registered with atexit
+        MatrixProfiler& profiler = instance(); //shared profiler
+        std::string path; //copy of dump path
+        {
+            std::lock_guard<std::mutex> guard(profiler.dumpLock); //locks path
+            path = profiler.dumpPath; //copies path
+        } //ends lock scope
+        if (path == "stderr" || path == "-") { //runs if profile goes to the terminal
+            profiler.dump(std::cerr); //writes to stderr
+        } else if (!path.empty()) { //runs if profile goes to a file
+            std::ofstream file(path); //opens file
+            profiler.dump(file); //writes profile
+        } //ends if statement
+    } //ends function
+
+    MatrixProfiler() { //reads MATRIX_PROFILE and MATRIX_PROFILE_HW
+        const char* path = std::getenv("MATRIX_PROFILE"); //optional dump target, stderr or a file path
+        if (path != nullptr && *path != '\0') { //runs if a dump was requested
+            enabled = true; //starts recording
+            dumpPath = path; //remembers target
+        } //ends if statement
+        const char* hw = std::getenv("MATRIX_PROFILE_HW"); //optional hardware counter switch
+        if (hw != nullptr && std::string(hw) == "1") { //runs if hardware counters were requested
+            hardware = true; //reads counters around each call
+        } //ends if statement
+        std::atexit(dumpAtExit); //writes profile at exit if a path is set by then
+    } //ends constructor
+
+public: //public functions available outside class definition
+    static MatrixProfiler& instance() { //function returns the shared profiler
+        static MatrixProfiler* profiler = new MatrixProfiler(); //never destroyed, so calls made during exit can still record
+        return *profiler; //returns profiler
+    } //ends function
+
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); } //function checks if calls are recorded
+    bool usesHardware() const { return hardware.load(std::memory_order_relaxed); } //function checks if hardware counters are read
+    void setEnabled(bool on) { enabled = on; } //function starts or stops recording
+    void setHardware(bool on) { hardware = on; } //function starts or stops reading hardware counters
+
+    void setDumpPath(const std::string& path) { //function sets where the profile is written at exit, stderr or a file path, empty for nowhere
+        std::lock_guard<std::mutex> guard(dumpLock); //locks path
+        dumpPath = path; //stores path
+    } //ends function
+
+    void record(MatrixOp op, uint64_t nanoseconds, uint64_t bytes, uint64_t flops, const uint64_t* hardwareDelta) { //function adds one call to an operation's totals
+        Counters& c = counters[static_cast<size_t>(op)]; //totals for op
+        c.calls.fetch_add(1, std::memory_order_relaxed); //counts call
+        c.nanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed); //adds time
+        c.bytes.fetch_add(bytes, std::memory_order_relaxed); //adds bytes
+        c.flops.fetch_add(flops, std::memory_order_relaxed); //adds operations
+        if (hardwareDelta != nullptr) { //runs if hardware counters were read
+            c.cycles.fetch_add(hardwareDelta[0], std::memory_order_relaxed); //adds cycles
+            c.instructions.fetch_add(hardwareDelta[1], std::memory_order_relaxed); //adds instructions
+            c.cacheMisses.fetch_add(hardwareDelta[2], std::memory_order_relaxed); //adds cache misses
+        } //ends if statement
+    } //ends function
+
+    MatrixOpStats stats(MatrixOp op) const { //function returns a snapshot of an operation's totals
+        const Counters& c = counters[static_cast<size_t>(op)]; //totals for op
+        MatrixOpStats result; //snapshot
+        result.calls = c.calls.load(std::memory_order_relaxed); //copies calls
+        result.nanoseconds = c.nanoseconds.load(std::memory_order_relaxed); //copies time
+        result.bytes = c.bytes.load(std::memory_order_relaxed); //copies bytes
+        result.flops = c.flops.load(std::memory_order_relaxed); //copies operations
+        result.cycles = c.cycles.load(std::memory_order_relaxed); //copies cycles
+        result.instructions = c.instructions.load(std::memory_order_relaxed); //copies instructions
+        result.cacheMisses = c.cacheMisses.load(std::memory_order_relaxed); //copies cache misses
+        return result; //returns snapshot
+    } //ends function
+
+    void reset() { //function zeros every operation's totals
+        for (Counters& c : counters) { //runs for each operation
+            c.calls = 0; c.nanoseconds = 0; c.bytes = 0; c.flops = 0; //zeros software totals
+            c.cycles = 0; c.instructions = 0; c.cacheMisses = 0; //zeros hardware totals
+        } //ends for loop
+    } //ends function
+
+    void dump(std::ostream& out) const { //function writes every operation's totals as one JSON object
+        out << "{\"compiled\": "; //start of object
+#ifdef MATRIX_ENABLE_PROFILING //hooks are only present when built with profiling
+        out << "true"; //hooks record calls
+#else //runs if hooks were compiled out
+        out << "false"; //totals stay zero
+#endif //ends preprocessor check
+        out << ", \"hardware\": " << (usesHardware() && HardwareCounters::forThisThread().isAvailable() ? "true" : "false") << ", \"ops\": [\n"; //hardware counter state
+        for (size_t i = 0; i < static_cast<size_t>(MatrixOp::Count); ++i) { //runs for each operation
+            const MatrixOp op = static_cast<MatrixOp>(i); //operation
+            const MatrixOpStats s = stats(op); //totals
+            const double seconds = s.nanoseconds * 1e-9; //time in seconds
+            out << "  {\"op\": \"" << matrixOpName(op) << "\", \"calls\": " << s.calls << ", \"seconds\": " << seconds //call count and time
+                << ", \"bytes\": " << s.bytes << ", \"flops\": " << s.flops //work done
+                << ", \"gflops\": " << (seconds > 0 ? s.flops / seconds * 1e-9 : 0.0) << ", \"bytes_per_second\": " << (seconds > 0 ? s.bytes / seconds : 0.0) //rates
+                << ", \"cycles\": " << s.cycles << ", \"instructions\": " << s.instructions << ", \"cache_misses\": " << s.cacheMisses //hardware totals
+                << ", \"ipc\": " << (s.cycles > 0 ? static_cast<double>(s.instructions) / s.cycles : 0.0) << "}" //instructions per cycle
+                << (i + 1 < static_cast<size_t>(MatrixOp::Count) ? "," : "") << "\n"; //separator
+        } //ends for loop
+        out << "]}\n"; //end of object
+    } //ends function
+}; //ends MatrixProfiler class definition
+
+inline MatrixOpStats getMatrixOpStats(MatrixOp op) { return MatrixProfiler::instance().stats(op); } //function returns an operation's totals
+inline void resetMatrixProfile() { MatrixProfiler::instance().reset(); } //function zeros every operation's totals
+inline void dumpMatrixProfile(std::ostream& out) { MatrixProfiler::instance().dump(out); } //function writes every operation's totals as JSON
+inline void setMatrixProfiling(bool on) { MatrixProfiler::instance().setEnabled(on); } //function starts or stops recording, only has an effect when built with MATRIX_ENABLE_PROFILING
+inline void setMatrixProfilingHardware(bool on) { MatrixProfiler::instance().setHardware(on); } //function starts or stops reading cycle, instruction and cache miss counters
+inline void setMatrixProfileDumpPath(const std::string& path) { MatrixProfiler::instance().setDumpPath(path); } //function sets where the profile is written at exit
+
+class MatrixProfileScope { //records the time, bytes and operations of one call when it leaves scope
+private: //private members only accessible within MatrixProfileScope class
+    MatrixOp op; //operation being timed
+    uint64_t bytes; //bytes the call touches
+    uint64_t flops; //operations the call performs
+    bool active; //true if profiling was on when the call started
+    bool hardware = false; //true if hardware counters were read at the start
+    uint64_t hardwareStart[3] = {0, 0, 0}; //counter values at the start
+    std::chrono::steady_clock::time_point start; //wall time at the start
+
+public: //public functions available outside class definition
+    MatrixProfileScope(MatrixOp operation, uint64_t bytesTouched, uint64_t operations) : op(operation), bytes(bytesTouched), flops(operations), active(MatrixProfiler::instance().isEnabled()) { //starts timing if profiling is on
+        if (!active) { //runs if profiling is off
+            return; //costs one relaxed load
+        } //ends if statement
+        if (MatrixProfiler::instance().usesHardware()) { //runs if hardware counters were requested
+            hardware = HardwareCounters::forThisThread().read(hardwareStart); //reads counters, false if unavailable
+        } //ends if statement
+        start = std::chrono::steady_clock::now(); //reads clock last so counter reads are not timed
+    } //ends constructor
+
+    ~MatrixProfileScope() { //adds this call to the totals
+        if (!active) { //runs if profiling was off
+            return; //nothing recorded
+        } //ends if statement
+        const uint64_t nanoseconds = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count()); //wall time of call
+        uint64_t hardwareEnd[3]; //counter values at the end
+        hardware = hardware && HardwareCounters::forThisThread().read(hardwareEnd); //reads counters
+        uint64_t delta[3] = {0, 0, 0}; //counter change across call
+        for (size_t i = 0; hardware && i < 3; ++i) { //runs for each counter if they were read
+            delta[i] = hardwareEnd[i] - hardwareStart[i]; //change in counter
+        } //ends for loop
+        MatrixProfiler::instance().record(op, nanoseconds, bytes, flops, hardware ? delta : nullptr); //adds to totals
+    } //ends destructor
+
+    MatrixProfileScope(const MatrixProfileScope&) = delete; //one scope per call
+    MatrixProfileScope& operator=(const MatrixProfileScope&) = delete; //one scope per call
+}; //ends MatrixProfileScope class definition
+
+#ifdef MATRIX_ENABLE_PROFILING //hooks are compiled in only when asked for
+#define MATRIX_PROFILE_SCOPE(op, bytes, flops) MatrixProfileScope matrixProfileScope((op), static_cast<uint64_t>(bytes), static_cast<uint64_t>(flops)) //times the rest of the enclosing block
+inline const bool matrixProfilerStarted = (MatrixProfiler::instance(), true); //creates profiler at startup so MATRIX_PROFILE dumps even if no operation runs
+#else //runs if profiling is compiled out
+#define MATRIX_PROFILE_SCOPE(op, bytes, flops) static_cast<void>(0) //compiles to nothing, arguments are not evaluated
+#endif //ends preprocessor check
+
+template <typename T> //declares template for a generic element type T (const T for read-only rows)
+class RowSpan { //lightweight view of one matrix row, does not own its data
+private: //private members only accessible within RowSpan class
+    T* first; //pointer to first element of the row
+    size_t length; //number of elements in the row
+
+public: //public functions available outside class definition
+    RowSpan(T* pointer, size_t count) : first(pointer), length(count) {} //creates view over count elements starting at pointer
+    template <typename U> //declares template so RowSpan<T> converts to RowSpan<const T>
+    RowSpan(const RowSpan<U>& other) : first(other.data()), length(other.size()) {} //converting constructor
+
+    T& operator[](size_t index) const { return first[index]; } //unchecked element access, same as indexing a vector row
+    T& at(size_t index) const { //checked element access
+        if (index >= length) { //runs if index is out of range of row
+            throw std::out_of_range("Index out of range"); //throws error
+        } //ends if statement
+        return first[index]; //returns element
+    } //ends function
+
+    size_t size() const { return length; } //returns number of elements in row
+    T* data() const { return first; } //returns pointer to first element
+    T* begin() const { return first; } //iterator to start of row
+    T* end() const { return first + length; } //iterator to end of row
+}; //ends RowSpan class definition
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) //x86 SIMD kernels need GCC/Clang target attributes
+#define MATRIX_HAVE_X86_KERNELS 1 //enables AVX2/AVX-512 micro-kernels below
+#endif //ends preprocessor check
+
+class ThreadPool { //work-stealing pool of worker threads shared by the matrix operations
+private: //private members only accessible within ThreadPool class
+    struct WorkQueue { //one deque of tasks per worker, owner pops from the back and thieves take from the front
+        std::mutex lock; //guards tasks
+        std::deque<std::function<void()> > tasks; //queued tasks
+    }; //ends WorkQueue definition
+
+    struct Batch { //tracks one parallelFor call until all of its chunks finish
+        std::atomic<size_t> remaining{0}; //chunks not finished yet
+        std::mutex lock; //guards error and wakes the waiting caller
+        std::condition_variable done; //signaled when remaining reaches zero
+        std::exception_ptr error; //first exception thrown by a chunk
+    }; //ends Batch definition
+
+    std::vector<std::unique_ptr<WorkQueue> > queues; //one queue per worker thread
+    std::vector<std::thread> workers; //worker threads, the calling thread also runs tasks
+    std::mutex sleepLock; //guards sleeping workers
+    std::condition_variable wake; //wakes idle workers when tasks arrive
+    std::atomic<size_t> pending{0}; //tasks queued but not yet taken
+    std::atomic<size_t> nextQueue{0}; //round-robin position for new tasks
+    bool stopping = false; //set when the pool is being destroyed
+
+    bool runOne(size_t home) { //takes one task, from home queue first then by stealing, and runs it
+        const size_t count = queues.size(); //number of queues
+        for (size_t offset = 0; offset < count; ++offset) { //runs for each queue starting at home
+            WorkQueue& queue = *queues[(home + offset) % count]; //queue being checked
+            std::function<void()> task; //task taken from queue
+            { //scope for queue lock
+                std::lock_guard<std::mutex> guard(queue.lock); //locks queue
+                if (queue.tasks.empty()) { //runs if queue has nothing to take
+                    continue; //tries next queue
+                } //ends if statement
+                if (offset == 0) { //runs if this is the home queue
+                    task = std::move(queue.tasks.back()); //owner takes newest task
+                    queue.tasks.pop_back(); //removes it
+                } else { //runs if stealing from another queue
+                    task = std::move(queue.tasks.front()); //thief takes oldest task
+                    queue.tasks.pop_front(); //removes it
+                } //ends if statement
+            } //ends scope
+            pending.fetch_sub(1, std::memory_order_relaxed); //one fewer queued task
+            task(); //runs task
+            return true; //reports that a task ran
+        } //ends for loop
+        return false; //reports that every queue was empty
+    } //ends function
+
+    void workerLoop(size_t id) { //body of each worker thread
+        while (true) { //runs until pool is stopped
+            if (runOne(id)) { //runs if a task was found
+                continue; //looks for more work straight away
+            } //ends if statement
+            std::unique_lock<std::mutex> guard(sleepLock); //locks sleep state
+            wake.wait(guard, [this] { return stopping || pending.load() > 0; }); //sleeps until work arrives
+            if (stopping && pending.load() == 0) { //runs if pool is shutting down with nothing left
+                return; //ends thread
+            } //ends if statement
+        } //ends while loop
+    } //ends function
+
+public: //public functions available outside class definition
+    explicit ThreadPool(size_t threads) { //creates a pool that runs tasks on threads threads including the caller
+        const size_t workerCount = threads > 1 ? threads - 1 : 0; //calling thread counts as one of the threads
+        for (size_t i = 0; i < std::max<size_t>(workerCount, 1); ++i) { //runs for each queue, at least one so callers always have somewhere to push
+            queues.push_back(std::unique_ptr<WorkQueue>(new WorkQueue())); //creates queue
+        } //ends for loop
+        for (size_t i = 0; i < workerCount; ++i) { //runs for each worker
+            workers.emplace_back(&ThreadPool::workerLoop, this, i); //starts worker thread
+        } //ends for loop
+    } //ends constructor
+
+    ~ThreadPool() { //stops and joins all workers
+        { //scope for sleep lock
+            std::lock_guard<std::mutex> guard(sleepLock); //locks sleep state
+            stopping = true; //tells workers to exit
+        } //ends scope
+        wake.notify_all(); //wakes every worker
+        for (auto& worker : workers) { //runs for each worker
+            worker.join(); //waits for worker to exit
+        } //ends for loop
+    } //ends destructor
+
+    ThreadPool(const ThreadPool&) = delete; //pools own threads so cannot be copied
+    ThreadPool& operator=(const ThreadPool&) = delete; //pools own threads so cannot be copied
+
+    size_t threadCount() const { return workers.size() + 1; } //number of threads that run tasks, including the caller
+
+    void parallelFor(size_t begin, size_t end, size_t grain, const std::function<void(size_t, size_t)>& body) { //splits [begin, end) into chunks of at least grain and runs body on each
+        const size_t total = end > begin ? end - begin : 0; //number of indices
+        grain = std::max<size_t>(grain, 1); //chunks need at least one index
+        if (total == 0) { //runs if range is empty
+            return; //nothing to do
+        } //ends if statement
+        if (workers.empty() || total <= grain) { //runs if there is nobody to share with or not enough work
+            body(begin, end); //runs whole range on calling thread
+            return; //finished
+        } //ends if statement
+        const size_t chunks = std::min((total + grain - 1) / grain, threadCount() * 4); //a few chunks per thread so stealing can balance load
+        const size_t chunkSize = (total + chunks - 1) / chunks; //indices per chunk
+        auto batch = std::make_shared<Batch>(); //completion tracking shared with tasks
+        batch->remaining.store((total + chunkSize - 1) / chunkSize); //number of chunks actually created
+        for (size_t first = begin; first < end; first += chunkSize) { //runs for each chunk
+            const size_t last = std::min(end, first + chunkSize); //end of chunk
+            WorkQueue& queue = *queues[nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size()]; //queue chosen round-robin
+            { //scope for queue lock
+                std::lock_guard<std::mutex> guard(queue.lock); //locks queue
+                queue.tasks.emplace_back([batch, &body, first, last] { //task runs body on one chunk
+                    try { //block runs if it doesn't error
+                        body(first, last); //runs chunk
+                    } catch (...) { //runs if chunk threw
+                        std::lock_guard<std::mutex> errorGuard(batch->lock); //locks error slot
+                        if (!batch->error) { //runs if this is the first error
+                            batch->error = std::current_exception(); //keeps error for caller
+                        } //ends if statement
+                    } //ends catch block
+                    if (batch->remaining.fetch_sub(1) == 1) { //runs if this was the last chunk
+                        std::lock_guard<std::mutex> doneGuard(batch->lock); //locks batch so the caller cannot miss the signal
+                        batch->done.notify_all(); //wakes caller
+                    } //ends if statement
+                }); //ends task
+            } //ends scope
+            pending.fetch_add(1, std::memory_order_relaxed); //one more queued task
+        } //ends for loop
+        { //scope for sleep lock
+            std::lock_guard<std::mutex> guard(sleepLock); //locks sleep state so no worker misses the wakeup
+        } //ends scope
+        wake.notify_all(); //wakes idle workers
+        size_t home = 0; //queue the caller checks first
+        while (batch->remaining.load() > 0) { //runs until every chunk finished
+            if (runOne(home++ % queues.size())) { //runs if caller helped with a task
+                continue; //keeps helping
+            } //ends if statement
+            std::unique_lock<std::mutex> guard(batch->lock); //locks batch
+            batch->done.wait(guard, [&batch] { return batch->remaining.load() == 0; }); //waits for chunks running on workers
+        } //ends while loop
+        if (batch->error) { //runs if a chunk threw
+            std::rethrow_exception(batch->error); //passes error to caller
+        } //ends if statement
+    } //ends function
+}; //ends ThreadPool class definition
+
+inline size_t defaultThreadCount() { //function picks the thread count used when none is set
+    const char* requested = std::getenv("MATRIX_THREADS"); //optional override from environment
+    if (requested != nullptr) { //runs if override is set
+        const long count = std::strtol(requested, nullptr, 10); //parses thread count
+        if (count > 0) { //runs if count is usable
+            return static_cast<size_t>(count); //uses requested count
+        } //ends if statement
+    } //ends if statement
+    const unsigned hardware = std::thread::hardware_concurrency(); //number of hardware threads
+    return hardware > 0 ? hardware : 1; //falls back to one thread if unknown
+} //ends function
+
+inline std::unique_ptr<ThreadPool>& matrixThreadPoolSlot() { //holds the pool shared by all Matrix operations
+    static std::unique_ptr<ThreadPool> pool(new ThreadPool(defaultThreadCount())); //created on first use, static initialization is thread-safe so concurrent first callers share one pool
+    return pool; //returns slot
+} //ends function
+
+inline ThreadPool& matrixThreadPool() { return *matrixThreadPoolSlot(); } //function returns the shared pool, creating it on first use
+
+inline void setMatrixThreadCount(size_t threads) { //function sets how many threads Matrix operations use, must not be called while one is running
+    matrixThreadPoolSlot().reset(new ThreadPool(threads > 0 ? threads : 1)); //replaces pool, old workers are joined
+} //ends function
+
+inline size_t getMatrixThreadCount() { return matrixThreadPool().threadCount(); } //function returns how many threads Matrix operations use
+
+enum class SimdLevel { Portable, Avx2, Avx512 }; //instruction sets the multiplication kernels can use
+
+inline SimdLevel detectSimdLevel() { //function checks which instruction sets this CPU supports
+    SimdLevel level = SimdLevel::Portable; //plain C++ works everywhere
+#ifdef MATRIX_HAVE_X86_KERNELS //only x86 has the feature bits checked here
+    __builtin_cpu_init(); //fills in CPU feature information
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) { //runs if AVX2 and FMA are available
+        level = SimdLevel::Avx2; //uses 256-bit kernels
+    } //ends if statement
+    if (__builtin_cpu_supports("avx512f")) { //runs if AVX-512 foundation is available
+        level = SimdLevel::Avx512; //uses 512-bit kernels
+    } //ends if statement
+#endif //ends preprocessor check
+    const char* requested = std::getenv("MATRIX_SIMD"); //optional override, lets slower kernels be forced for testing
+    if (requested != nullptr) { //runs if override is set
+        const std::string name(requested); //name of requested instruction set
+        if (name == "portable") { //runs if portable code was requested
+            level = SimdLevel::Portable; //forces plain C++ kernel
+        } else if (name == "avx2" && level == SimdLevel::Avx512) { //runs if AVX2 was requested on an AVX-512 machine
+            level = SimdLevel::Avx2; //forces 256-bit kernels
+        } //ends if statement
+    } //ends if statement
+    return level; //returns best supported level
+} //ends function
+
+inline SimdLevel activeSimdLevel() { //function returns the instruction set chosen for this process
+    static const SimdLevel level = detectSimdLevel(); //detects once on first use
+    return level; //returns cached level
+} //ends function
+
+template <typename T> //declares template for a generic type T
+struct GemmBlocking { //register and cache tile sizes used by the blocked multiply
+    static constexpr size_t MR = 4; //rows of C computed by one micro-kernel call
+    static constexpr size_t NR = 64 / sizeof(T) >= 8 ? 64 / sizeof(T) : 8; //cols of C computed by one micro-kernel call, one cache line of B
+    static constexpr size_t KC = 256; //depth of packed panels, keeps a B micro-panel in L1
+    static constexpr size_t MC = 128; //rows of packed A block, sized for L2
+    static constexpr size_t NC = 2048; //cols of packed B panel, sized for L3
+}; //ends GemmBlocking definition
+
+template <typename T> //declares template for a generic type T
+using MicroKernel = void (*)(size_t kc, const T* a, const T* b, T* tile); //computes an MR x NR tile from packed panels
+
+template <typename T> //declares template for a generic type T
+void microKernelPortable(size_t kc, const T* a, const T* b, T* tile) { //plain C++ micro-kernel, used when no SIMD kernel applies
+    constexpr size_t MR = GemmBlocking<T>::MR; //rows in tile
+    constexpr size_t NR = GemmBlocking<T>::NR; //cols in tile
+    T acc[MR][NR] = {}; //accumulators for the tile, start at zero
+    for (size_t p = 0; p < kc; ++p) { //runs for depth of panels
+        for (size_t i = 0; i < MR; ++i) { //runs for rows of tile
+            const T left = a[p * MR + i]; //element of packed A
+            for (size_t j = 0; j < NR; ++j) { //runs for cols of tile
+                acc[i][j] += left * b[p * NR + j]; //multiplies and accumulates
+            } //ends for loop
+        } //ends for loop
+    } //ends for loop
+    for (size_t i = 0; i < MR; ++i) { //runs for rows of tile
+        for (size_t j = 0; j < NR; ++j) { //runs for cols of tile
+            tile[i * NR + j] = acc[i][j]; //stores accumulators to tile
+        } //ends for loop
+    } //ends for loop
+} //ends function
+
+#ifdef MATRIX_HAVE_X86_KERNELS //x86 SIMD micro-kernels
+__attribute__((target("avx2,fma"))) inline void microKernelAvx2(size_t kc, const double* a, const double* b, double* tile) { //4x8 double tile, two ymm registers per row
+    __m256d c[4][2]; //accumulators for the tile
+    for (size_t i = 0; i < 4; ++i) { //runs for rows of tile
+        c[i][0] = _mm256_setzero_pd(); //clears left half of row
+        c[i][1] = _mm256_setzero_pd(); //clears right half of row
+    } //ends for loop
+    for (size_t p = 0; p < kc; ++p, a += 4, b += 8) { //runs for depth of panels
+        const __m256d b0 = _mm256_loadu_pd(b); //left half of B row
+        const __m256d b1 = _mm256_loadu_pd(b + 4); //right half of B row
+        for (size_t i = 0; i < 4; ++i) { //runs for rows of tile
+            const __m256d left = _mm256_broadcast_sd(a + i); //broadcasts element of packed A
+            c[i][0] = _mm256_fmadd_pd(left, b0, c[i][0]); //fused multiply-add into left half
+            c[i][1] = _mm256_fmadd_pd(left, b1, c[i][1]); //fused multiply-add into right half
+        } //ends for loop
+    } //ends for loop
+    for (size_t i = 0; i < 4; ++i) { //runs for rows of tile
+        _mm256_storeu_pd(tile + i * 8, c[i][0]); //stores left half of row
+        _mm256_storeu_pd(tile + i * 8 + 4, c[i][1]); //stores right half of row
+    } //ends for loop
+} //ends function
+
+__attribute__((target("avx2,fma"))) inline void microKernelAvx2(size_t kc, const float* a, const float* b, float* tile) { //4x16 float tile, two ymm registers per row
+    __m256 c[4][2]; //accumulators for the tile
+    for (size_t i = 0; i < 4; ++i) { //runs for rows of tile
+        c[i][0] = _mm256_setzero_ps(); //clears left half of row
+        c[i][1] = _mm256_setzero_ps(); //clears right half of row
+    } //ends for loop
+    for (size_t p = 0; p < kc; ++p, a += 4, b += 16) { //runs for depth of panels
+        const __m256 b0 = _mm256_loadu_ps(b); //left half of B row
+        const __m256 b1 = _mm256_loadu_ps(b + 8); //right half of B row
+        for (size_t i = 0; i < 4; ++i) { //runs for rows of tile
+            const __m256 left = _mm256_broadcast_ss(a + i); //broadcasts element of packed A
+            c[i][0] = _mm256_fmadd_ps(left, b0, c[i][0]); //fused multiply-add into left half
+            c[i][1] = _mm256_fmadd_ps(left, b1, c[i][1]); //fused multiply-add into right half
+        } //ends for loop
+    } //ends for loop
+    for (size_t i = 0; i < 4; ++i) { //runs for rows of tile
+        _mm256_storeu_ps(tile + i * 16, c[i][0]); //stores left half of row
+        _mm256_storeu_ps(tile + i * 16 + 8, c[i][1]); //stores right half of row
+    } //ends for loop
+} //ends function
+
+__attribute__((target("avx2"))) inline void microKernelAvx2(size_t kc, const int* a, const int* b, int* tile) { //4x16 int tile, two ymm registers per row
+    __m256i c[4][2]; //accumulators for the tile
+    for (size_t i = 0; i < 4; ++i) { //runs for rows of tile
+        c[i][0] = _mm256_setzero_si256(); //clears left half of row
+        c[i][1] = _mm256_setzero_si256(); //clears right half of row
+    } //ends for loop
+    for (size_t p = 0; p < kc; ++p, a += 4, b += 16) { //runs for depth of panels
+        const __m256i b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b)); //left half of B row
+        const __m256i b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + 8)); //right half of B row
+        for (size_t i = 0; i < 4; ++i) { //runs for rows of tile
+            const __m256i left = _mm256_set1_epi32(a[i]); //broadcasts element of packed A
+            c[i][0] = _mm256_add_epi32(c[i][0], _mm256_mullo_epi32(left, b0)); //multiply-add into left half, wraps like int math
+            c[i][1] = _mm256_add_epi32(c[i][1], _mm256_mullo_epi32(left, b1)); //multiply-add into right half
+        } //ends for loop
+    } //ends for loop
+    for (size_t i = 0; i < 4; ++i) { //runs for rows of tile
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(tile + i * 16), c[i][0]); //stores left half of row
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(tile + i * 16 + 8), c[i][1]); //stores right half of row
+    } //ends for loop
+} //ends function
+
+//AVX-512 kernels hold a whole tile row in one register, so even and odd k steps use separate accumulators to keep enough FMAs in flight
+__attribute__((target("avx512f"))) inline void microKernelAvx512(size_t kc, const double* a, const double* b, double* tile) { //4x8 double tile, one zmm register per row
+    __m512d even[4], odd[4]; //accumulators for even and odd k steps
+    for (size_t i = 0; i < 4; ++i) { //runs for rows of tile
+        even[i] = _mm512_setzero_pd(); //clears even accumulator
+        odd[i] = _mm512_setzero_pd(); //clears odd accumulator
+    } //ends for loop
+    size_t p = 0; //current depth
+    for (; p + 1 < kc; p += 2, a += 8, b += 16) { //runs two depth steps at a time
+        const __m512d b0 = _mm512_loadu_pd(b); //B row for even step
+        const __m512d b1 = _mm512_loadu_pd(b + 8); //B row for odd step
+        for (size_t i = 0; i < 4; ++i) { //runs for rows of tile
+            even[i] = _mm512_fmadd_pd(_mm512_set1_pd(a[i]), b0, even[i]); //fused multiply-add for even step
+            odd[i] = _mm512_fmadd_pd(_mm512_set1_pd(a[4 + i]), b1, odd[i]); //fused multiply-add for odd step
+        } //ends for loop
+    } //ends for loop
+    if (p < kc) { //runs if depth was odd
+        const __m512d b0 = _mm512_loadu_pd(b); //last B row
+        for (size_t i = 0; i < 4; ++i) { //runs for rows of tile
+            even[i] = _mm512_fmadd_pd(_mm512_set1_pd(a[i]), b0, even[i]); //fused multiply-add for last step
+        } //ends for loop
+    } //ends if statement
+    for (size_t i = 0; i < 4; ++i) { //runs for rows of tile
+        _mm512_storeu_pd(tile + i * 8, _mm512_add_pd(even[i], odd[i])); //combines accumulators and stores row
+    } //ends for loop
+} //ends function
+
+__attribute__((target("avx512f"))) inline void microKernelAvx512(size_t kc, const float* a, const float* b, float* tile) { //4x16 float tile, one zmm register per row
+    __m512 even[4], odd[4]; //accumulators for even and odd k steps
+    for (size_t i = 0; i < 4; ++i) { //runs for rows of tile
+        even[i] = _mm512_setzero_ps(); //clears even accumulator
+        odd[i] = _mm512_setzero_ps(); //clears odd accumulator
+    } //ends for loop
+    size_t p = 0; //current depth
+    for (; p + 1 < kc; p += 2, a += 8, b += 32) { //runs two depth steps at a time
+        const __m512 b0 = _mm512_loadu_ps(b); //B row for even step
+        const __m512 b1 = _mm512_loadu_ps(b + 16); //B row for odd step
+        for (size_t i = 0; i < 4; ++i) { //runs for rows of tile
+            even[i] = _mm512_fmadd_ps(_mm512_set1_ps(a[i]), b0, even[i]); //fused multiply-add for even step
+            odd[i] = _mm512_fmadd_ps(_mm512_set1_ps(a[4 + i]), b1, odd[i]); //fused multiply-add for odd step
+        } //ends for loop
+    } //ends for loop
+    if (p < kc) { //runs if depth was odd
+        const __m512 b0 = _mm512_loadu_ps(b); //last B row
+        for (size_t i = 0; i < 4; ++i) { //runs for rows of tile
+            even[i] = _mm512_fmadd_ps(_mm512_set1_ps(a[i]), b0, even[i]); //fused multiply-add for last step
+        } //ends for loop
+    } //ends if statement
+    for (size_t i = 0; i < 4; ++i) { //runs for rows of tile
+        _mm512_storeu_ps(tile + i * 16, _mm512_add_ps(even[i], odd[i])); //combines accumulators and stores row
+    } //ends for loop
+} //ends function
+
+__attribute__((target("avx512f"))) inline void microKernelAvx512(size_t kc, const int* a, const int* b, int* tile) { //4x16 int tile, one zmm register per row
+    __m512i even[4], odd[4]; //accumulators for even and odd k steps
+    for (size_t i = 0; i < 4; ++i) { //runs for rows of tile
+        even[i] = _mm512_setzero_si512(); //clears even accumulator
+        odd[i] = _mm512_setzero_si512(); //clears odd accumulator
+    } //ends for loop
+    size_t p = 0; //current depth
+    for (; p + 1 < kc; p += 2, a += 8, b += 32) { //runs two depth steps at a time
+        const __m512i b0 = _mm512_loadu_si512(b); //B row for even step
+        const __m512i b1 = _mm512_loadu_si512(b + 16); //B row for odd step
+        for (size_t i = 0; i < 4; ++i) { //runs for rows of tile
+            even[i] = _mm512_add_epi32(even[i], _mm512_mullo_epi32(_mm512_set1_epi32(a[i]), b0)); //multiply-add for even step
+            odd[i] = _mm512_add_epi32(odd[i], _mm512_mullo_epi32(_mm512_set1_epi32(a[4 + i]), b1)); //multiply-add for odd step
+        } //ends for loop
+    } //ends for loop
+    if (p < kc) { //runs if depth was odd
+        const __m512i b0 = _mm512_loadu_si512(b); //last B row
+        for (size_t i = 0; i < 4; ++i) { //runs for rows of tile
+            even[i] = _mm512_add_epi32(even[i], _mm512_mullo_epi32(_mm512_set1_epi32(a[i]), b0)); //multiply-add for last step
+        } //ends for loop
+    } //ends if statement
+    for (size_t i = 0; i < 4; ++i) { //runs for rows of tile
+        _mm512_storeu_si512(tile + i * 16, _mm512_add_epi32(even[i], odd[i])); //combines accumulators and stores row
+    } //ends for loop
+} //ends function
+#endif //ends preprocessor check
+
+template <typename T> //declares template for a generic type T
+MicroKernel<T> selectMicroKernel() { //function picks the micro-kernel for element type T
+#ifdef MATRIX_HAVE_X86_KERNELS //only x86 has SIMD kernels
+    if constexpr (std::is_same<T, double>::value || std::is_same<T, float>::value || std::is_same<T, int>::value) { //runs for types with SIMD kernels
+        switch (activeSimdLevel()) { //switch on detected instruction set
+            case SimdLevel::Avx512: return static_cast<MicroKernel<T> >(&microKernelAvx512); //512-bit kernel
+            case SimdLevel::Avx2: return static_cast<MicroKernel<T> >(&microKernelAvx2); //256-bit kernel
+            case SimdLevel::Portable: break; //falls through to plain C++ kernel
+        } //ends switch block
+    } //ends if statement
+#endif //ends preprocessor check
+    return &microKernelPortable<T>; //plain C++ kernel
+} //ends function
+
+template <typename T> //declares template for a generic type T
+void packPanelA(size_t mc, size_t kc, const T* const* aRows, size_t row0, size_t col0, T scale, T* packed) { //copies an mc x kc block of A times scale into MR-row strips, zero padded
+    constexpr size_t MR = GemmBlocking<T>::MR; //rows per strip
+    for (size_t ir = 0; ir < mc; ir += MR) { //runs for each strip of rows
+        const size_t mr = std::min(MR, mc - ir); //rows in this strip
+        for (size_t p = 0; p < kc; ++p) { //runs for depth of block
+            for (size_t i = 0; i < MR; ++i) { //runs for rows of strip
+                *packed++ = i < mr ? scale * aRows[row0 + ir + i][col0 + p] : T(); //copies scaled element or pads with zero
+            } //ends for loop
+        } //ends for loop
+    } //ends for loop
+} //ends function
+
+template <typename T> //declares template for a generic type T
+void packPanelB(size_t kc, size_t nc, const T* const* bRows, size_t row0, size_t col0, T* packed) { //copies a kc x nc block of B into NR-col strips, zero padded
+    constexpr size_t NR = GemmBlocking<T>::NR; //cols per strip
+    for (size_t jr = 0; jr < nc; jr += NR) { //runs for each strip of cols
+        const size_t nr = std::min(NR, nc - jr); //cols in this strip
+        for (size_t p = 0; p < kc; ++p) { //runs for depth of block
+            const T* source = bRows[row0 + p] + col0 + jr; //start of row segment in B
+            for (size_t j = 0; j < NR; ++j) { //runs for cols of strip
+                *packed++ = j < nr ? source[j] : T(); //copies element or pads with zero
+            } //ends for loop
+        } //ends for loop
+    } //ends for loop
+} //ends function
+
+template <typename T> //declares template for a generic type T
+void gemmAccumulate(size_t m, size_t n, size_t k, const T* const* aRows, const T* const* bRows, T* const* cRows, T alpha = T(1)) { //computes C += alpha * A * B for an m x k A and k x n B given row pointers
+    constexpr size_t MR = GemmBlocking<T>::MR; //register tile rows
+    constexpr size_t NR = GemmBlocking<T>::NR; //register tile cols
+    constexpr size_t KC = GemmBlocking<T>::KC; //panel depth
+    constexpr size_t MC = GemmBlocking<T>::MC; //A block rows
+    constexpr size_t NC = GemmBlocking<T>::NC; //B panel cols
+    if (m == 0 || n == 0 || k == 0) { //runs if there is nothing to compute
+        return; //leaves C unchanged
+    } //ends if statement
+    const MicroKernel<T> kernel = selectMicroKernel<T>(); //micro-kernel for this CPU
+    ThreadPool& pool = matrixThreadPool(); //threads that share the work
+    const size_t kcMax = std::min(KC, k); //largest depth actually used
+    const size_t mcMax = std::min(MC, (m + MR - 1) / MR * MR); //largest A block actually used
+    const size_t ncMax = std::min(NC, (n + NR - 1) / NR * NR); //largest B panel actually used
+    std::vector<T, PooledAllocator<T> > packedB(kcMax * ncMax); //packed B panel, shared by all threads, reused from the pool across calls
+    const size_t rowBlocks = (m + MC - 1) / MC; //number of A blocks
+
+    for (size_t jc = 0; jc < n; jc += NC) { //runs for each B panel of cols
+        const size_t nc = std::min(NC, n - jc); //cols in this panel
+        const size_t strips = (nc + NR - 1) / NR; //NR-wide strips in this panel
+        const size_t colGroups = std::min(strips, std::max<size_t>(1, (2 * pool.threadCount() + rowBlocks - 1) / rowBlocks)); //splits cols too when there are too few row blocks to keep every thread busy
+        const size_t stripsPerGroup = (strips + colGroups - 1) / colGroups; //strips handled by one output tile
+        for (size_t pc = 0; pc < k; pc += KC) { //runs for each slice of depth, in order so every element of C sums in the same order
+            const size_t kc = std::min(KC, k - pc); //depth of this slice
+            pool.parallelFor(0, strips, 16, [&](size_t first, size_t last) { //packs B panel once for every A block, strips split across threads
+                const size_t width = std::min(nc, last * NR) - first * NR; //cols covered by these strips
+                packPanelB(kc, width, bRows, pc, jc + first * NR, packedB.data() + first * NR * kc); //packs strips
+            }); //ends parallel loop
+            pool.parallelFor(0, rowBlocks * colGroups, 1, [&](size_t first, size_t last) { //each index is one output tile of C, tiles never overlap
+                static thread_local std::vector<T, AlignedAllocator<T> > packedA; //packed A block owned by this thread
+                alignas(64) T tile[MR * NR]; //output of one micro-kernel call
+                packedA.resize(mcMax * kcMax); //grows buffer on first use
+                size_t packedBlock = rowBlocks; //A block currently packed, none yet
+                for (size_t task = first; task < last; ++task) { //runs for each output tile in this chunk
+                    const size_t block = task / colGroups; //A block for this tile
+                    const size_t ic = block * MC; //first row of tile
+                    const size_t mc = std::min(MC, m - ic); //rows in tile
+                    if (block != packedBlock) { //runs if neighbouring tile did not already pack this block
+                        packPanelA(mc, kc, aRows, ic, pc, alpha, packedA.data()); //packs A block, folding in alpha
+                        packedBlock = block; //remembers packed block
+                    } //ends if statement
+                    const size_t stripBegin = (task % colGroups) * stripsPerGroup; //first strip of tile
+                    const size_t stripEnd = std::min(strips, stripBegin + stripsPerGroup); //end strip of tile
+                    for (size_t strip = stripBegin; strip < stripEnd; ++strip) { //runs for each strip of cols
+                        const size_t jr = strip * NR; //first col of strip inside panel
+                        const size_t nr = std::min(NR, nc - jr); //cols in this strip
+                        const T* bStrip = packedB.data() + jr * kc; //packed strip of B
+                        for (size_t ir = 0; ir < mc; ir += MR) { //runs for each strip of rows
+                            const size_t mr = std::min(MR, mc - ir); //rows in this strip
+                            kernel(kc, packedA.data() + ir * kc, bStrip, tile); //computes one register tile
+                            for (size_t i = 0; i < mr; ++i) { //runs for rows of tile inside C
+                                T* out = cRows[ic + ir + i] + jc + jr; //destination row segment in C
+                                for (size_t j = 0; j < nr; ++j) { //runs for cols of tile inside C
+                                    out[j] += tile[i * NR + j]; //accumulates tile into C
+                                } //ends for loop
+                            } //ends for loop
+                        } //ends for loop
+                    } //ends for loop
+                } //ends for loop
+            }); //ends parallel loop
+        } //ends for loop
+    } //ends for loop
+} //ends function
+
+enum class MultiplyMode { Blocked, Strassen }; //algorithms Matrix multiplication can use
+
+struct MultiplySettings { //multiplication algorithm chosen for this process
+    MultiplyMode mode; //algorithm for products
+    size_t strassenCutoff; //Strassen hands sizes at or below this to the blocked kernel
+}; //ends MultiplySettings definition
+
+inline MultiplySettings defaultMultiplySettings() { //function reads MATRIX_MULTIPLY and MATRIX_STRASSEN_CUTOFF, blocked unless asked otherwise
+    MultiplySettings settings{MultiplyMode::Blocked, 512}; //blocked kernel, Strassen cutoff where it starts to pay off with the packed kernel
+    const char* mode = std::getenv("MATRIX_MULTIPLY"); //optional algorithm override
+    if (mode != nullptr && std::string(mode) == "strassen") { //runs if Strassen was requested
+        settings.mode = MultiplyMode::Strassen; //uses recursive multiply for large sizes
+    } //ends if statement
+    const char* cutoff = std::getenv("MATRIX_STRASSEN_CUTOFF"); //optional cutoff override
+    if (cutoff != nullptr && std::strtol(cutoff, nullptr, 10) > 0) { //runs if cutoff is usable
+        settings.strassenCutoff = static_cast<size_t>(std::strtol(cutoff, nullptr, 10)); //uses requested cutoff
+    } //ends if statement
+    return settings; //returns settings
+} //ends function
+
+inline MultiplySettings& multiplySettings() { //holds the settings shared by all Matrix products
+    static MultiplySettings settings = defaultMultiplySettings(); //read from environment on first use
+    return settings; //returns settings
+} //ends function
+
+inline void setMultiplyMode(MultiplyMode mode, size_t strassenCutoff = 0) { //function picks the multiplication algorithm, a cutoff of 0 keeps the current one, must not be called while a product is running
+    multiplySettings().mode = mode; //stores algorithm
+    if (strassenCutoff > 0) { //runs if a new cutoff was given
+        multiplySettings().strassenCutoff = strassenCutoff; //stores cutoff
+    } //ends if statement
+} //ends function
+
+inline MultiplyMode getMultiplyMode() { return multiplySettings().mode; } //function returns the multiplication algorithm
+inline size_t getStrassenCutoff() { return multiplySettings().strassenCutoff; } //function returns the size at or below which Strassen uses the blocked kernel
+
+template <typename T> //declares template for a generic type T
+struct StrassenBlock { //zeroed h x h scratch block with cache-line padded rows
+    size_t stride; //elements between rows
+    std::vector<T, PooledAllocator<T> > data; //elements, reused from the pool by the next block of this size
+    std::vector<T*> rows; //start of each row
+
+    explicit StrassenBlock(size_t n) : stride((n + 64 / sizeof(T) - 1) / (64 / sizeof(T)) * (64 / sizeof(T))), data(n * stride), rows(n) { //allocates block
+        for (size_t i = 0; i < n; ++i) { //runs for size of block
+            rows[i] = data.data() + i * stride; //row i
+        } //ends for loop
+    } //ends constructor
+
+    void clear() { std::fill(data.begin(), data.end(), T()); } //zeros block
+}; //ends StrassenBlock definition
+
+template <typename T> //declares template for a generic type T
+void strassenSum(size_t h, const T* const* x, const T* const* y, bool subtract, T* const* out) { //out = x + y, or x - y when subtract is set
+    matrixThreadPool().parallelFor(0, h, std::max<size_t>(1, 16384 / h), [&](size_t first, size_t last) { //splits rows across threads
+        for (size_t i = first; i < last; ++i) { //runs for rows in this range
+            for (size_t j = 0; j < h; ++j) { //runs for size of block
+                out[i][j] = subtract ? x[i][j] - y[i][j] : x[i][j] + y[i][j]; //combines elements
+            } //ends for loop
+        } //ends for loop
+    }); //ends parallel loop
+} //ends function
+
+template <typename T> //declares template for a generic type T
+void strassenAdd(size_t h, const T* const* product, T scale, std::initializer_list<T* const*> targets) { //adds scale * product into each target block
+    matrixThreadPool().parallelFor(0, h, std::max<size_t>(1, 16384 / h), [&](size_t first, size_t last) { //splits rows across threads
+        for (T* const* target : targets) { //runs for each block that uses this product
+            for (size_t i = first; i < last; ++i) { //runs for rows in this range
+                for (size_t j = 0; j < h; ++j) { //runs for size of block
+                    target[i][j] += scale * product[i][j]; //accumulates product
+                } //ends for loop
+            } //ends for loop
+        } //ends for loop
+    }); //ends parallel loop
+} //ends function
+
+//Strassen's recursion, C += alpha * A * B for n x n matrices given row pointers. Each level splits into 2 x 2 blocks and
+//forms 7 half-size products instead of 8, so the work is O(n^2.81) above the cutoff and the blocked kernel below it.
+//Odd sizes peel off the last row and col, which are finished with thin blocked products, so no padding is allocated.
+//Scratch memory is about n^2 elements in total across all levels.
+//int results are exact: every step is an integer add, subtract or multiply, so they match the blocked kernel as long as
+//no intermediate overflows, and operand sums can grow up to 2^levels times the largest element.
+//double results are not bit-identical to the blocked kernel. With unit roundoff u (2^-53), n0 the cutoff and max|.| the
+//largest element magnitude, the error for power-of-two n is bounded by (Higham, Accuracy and Stability, 23.2.2)
+//    max|C - fl(C)| <= [(n / n0)^log2(12) (n0^2 + 5 n0) - 5 n] u max|A| max|B| + O(u^2)
+//against n^2 u max|A| max|B| for the blocked kernel, so each level multiplies the bound by about 12 / 4 = 3.
+template <typename T> //declares template for a generic type T
+void strassenAccumulate(size_t n, const T* const* aRows, const T* const* bRows, T* const* cRows, T alpha, size_t cutoff) { //computes C += alpha * A * B, recursing until size is at most cutoff
+    if (n <= std::max<size_t>(cutoff, 1)) { //runs if block is small enough for the blocked kernel
+        gemmAccumulate(n, n, n, aRows, bRows, cRows, alpha); //packed, cache-blocked multiply
+        return; //finished
+    } //ends if statement
+    if (n % 2 == 1) { //runs for odd sizes, peeling the last row and col
+        const size_t m = n - 1; //even leading size
+        std::vector<const T*> aLastCol(m), bLastCol(n); //rows starting at col m
+        std::vector<T*> cLastCol(m); //rows of C starting at col m
+        for (size_t i = 0; i < n; ++i) { //runs for size of matrix
+            if (i < m) { //runs for leading rows
+                aLastCol[i] = aRows[i] + m; //A(i, m)
+                cLastCol[i] = cRows[i] + m; //C(i, m)
+            } //ends if statement
+            bLastCol[i] = bRows[i] + m; //B(i, m)
+        } //ends for loop
+        strassenAccumulate(m, aRows, bRows, cRows, alpha, cutoff); //C11 += A11 * B11
+        gemmAccumulate(m, m, 1, aLastCol.data(), bRows + m, cRows, alpha); //C11 += A12 * B21, a rank-1 update
+        gemmAccumulate(m, 1, n, aRows, bLastCol.data(), cLastCol.data(), alpha); //last col of C, leading rows
+        gemmAccumulate(1, n, n, aRows + m, bRows, cRows + m, alpha); //last row of C
+        return; //finished
+    } //ends if statement
+    const size_t h = n / 2; //size of each block
+    std::vector<const T*> a11(h), a12(h), a21(h), a22(h), b11(h), b12(h), b21(h), b22(h); //rows of the blocks of A and B
+    std::vector<T*> c11(h), c12(h), c21(h), c22(h); //rows of the blocks of C
+    for (size_t i = 0; i < h; ++i) { //runs for size of block
+        a11[i] = aRows[i]; a12[i] = aRows[i] + h; a21[i] = aRows[h + i]; a22[i] = aRows[h + i] + h; //blocks of A
+        b11[i] = bRows[i]; b12[i] = bRows[i] + h; b21[i] = bRows[h + i]; b22[i] = bRows[h + i] + h; //blocks of B
+        c11[i] = cRows[i]; c12[i] = cRows[i] + h; c21[i] = cRows[h + i]; c22[i] = cRows[h + i] + h; //blocks of C
+    } //ends for loop
+    StrassenBlock<T> left(h), right(h), product(h); //operand sums and one half-size product
+    const T* const* s = left.rows.data(); //left operand sum
+    const T* const* t = right.rows.data(); //right operand sum
+    const T* const* p = product.rows.data(); //half-size product
+    const T negative = T() - alpha; //scale for subtracted products
+
+    strassenSum(h, a11.data(), a22.data(), false, left.rows.data()); //A11 + A22
+    strassenSum(h, b11.data(), b22.data(), false, right.rows.data()); //B11 + B22
+    strassenAccumulate(h, s, t, product.rows.data(), T(1), cutoff); //M1 = (A11 + A22)(B11 + B22)
+    strassenAdd(h, p, alpha, {c11.data(), c22.data()}); //M1 goes to C11 and C22
+
+    strassenSum(h, a21.data(), a22.data(), false, left.rows.data()); //A21 + A22
+    product.clear(); //zeros product
+    strassenAccumulate(h, s, b11.data(), product.rows.data(), T(1), cutoff); //M2 = (A21 + A22) B11
+    strassenAdd(h, p, alpha, {c21.data()}); //M2 goes to C21
+    strassenAdd(h, p, negative, {c22.data()}); //and is taken from C22
+
+    strassenSum(h, b12.data(), b22.data(), true, right.rows.data()); //B12 - B22
+    product.clear(); //zeros product
+    strassenAccumulate(h, a11.data(), t, product.rows.data(), T(1), cutoff); //M3 = A11 (B12 - B22)
+    strassenAdd(h, p, alpha, {c12.data(), c22.data()}); //M3 goes to C12 and C22
+
+    strassenSum(h, b21.data(), b11.data(), true, right.rows.data()); //B21 - B11
+    product.clear(); //zeros product
+    strassenAccumulate(h, a22.data(), t, product.rows.data(), T(1), cutoff); //M4 = A22 (B21 - B11)
+    strassenAdd(h, p, alpha, {c11.data(), c21.data()}); //M4 goes to C11 and C21
+
+    strassenSum(h, a11.data(), a12.data(), false, left.rows.data()); //A11 + A12
+    product.clear(); //zeros product
+    strassenAccumulate(h, s, b22.data(), product.rows.data(), T(1), cutoff); //M5 = (A11 + A12) B22
+    strassenAdd(h, p, alpha, {c12.data()}); //M5 goes to C12
+    strassenAdd(h, p, negative, {c11.data()}); //and is taken from C11
+
+    strassenSum(h, a21.data(), a11.data(), true, left.rows.data()); //A21 - A11
+    strassenSum(h, b11.data(), b12.data(), false, right.rows.data()); //B11 + B12
+    strassenAccumulate(h, s, t, c22.data(), alpha, cutoff); //M6 = (A21 - A11)(B11 + B12) only goes to C22, so it is added in place
+
+    strassenSum(h, a12.data(), a22.data(), true, left.rows.data()); //A12 - A22
+    strassenSum(h, b21.data(), b22.data(), false, right.rows.data()); //B21 + B22
+    strassenAccumulate(h, s, t, c11.data(), alpha, cutoff); //M7 = (A12 - A22)(B21 + B22) only goes to C11, so it is added in place
+} //ends function
+
+template <typename T, size_t N = 0> //declares template for a generic type T and a compile-time size N, 0 for sizes chosen at run time
+class Matrix; //forward declaration so expressions can refer to Matrix
+class MappedFile; //forward declaration so matrices can keep a file mapping alive
+
+//expressions keep references to their matrices, so assign them to a Matrix in the same statement rather than holding them in auto variables
+template <typename Derived> //declares template for the concrete expression type
+struct MatrixExpr { //base of every element-wise matrix expression, evaluated lazily row by row
+    const Derived& self() const { return static_cast<const Derived&>(*this); } //casts to concrete expression
+}; //ends MatrixExpr definition
+
+template <typename E> //declares template for an expression type E
+struct ExprOperand { using type = const E; }; //expression nodes are small and stored by value
+template <typename T> //declares template for a generic type T
+struct ExprOperand<Matrix<T> > { using type = const Matrix<T>&; }; //matrices are stored by reference, never copied into an expression
+
+template <typename L, typename R> //declares template for left and right operand types
+class SumExpr : public MatrixExpr<SumExpr<L, R> > { //lazy element-wise sum of two expressions
+private: //private members only accessible within SumExpr class
+    typename ExprOperand<L>::type left; //left operand
+    typename ExprOperand<R>::type right; //right operand
+
+public: //public functions available outside class definition
+    using value_type = typename L::value_type; //element type of result
+    static constexpr size_t readsPerElement = L::readsPerElement + R::readsPerElement; //matrix elements read per result element
+    static constexpr size_t additionsPerElement = L::additionsPerElement + R::additionsPerElement + 1; //additions per result element
+    static constexpr size_t flopsPerElement = L::flopsPerElement + R::flopsPerElement + 1; //arithmetic operations per result element
+
+    SumExpr(const L& lhs, const R& rhs) : left(lhs), right(rhs) { //creates expression, nothing is computed yet
+        if (left.getSize() != right.getSize()) { //runs if matrices are different sizes
+            throw std::invalid_argument("Matrix sizes don't match for addition"); //throws error
+        } //ends if statement
+    } //ends constructor
+
+    size_t getSize() const { return left.getSize(); } //size of result
+
+    struct Reader { //reads one row of the sum, element by element
+        typename L::Reader leftRow; //reader for left row
+        typename R::Reader rightRow; //reader for right row
+        value_type operator[](size_t col) const { return leftRow[col] + rightRow[col]; } //adds elements
+    }; //ends Reader definition
+
+    Reader rowReader(size_t row) const { return Reader{left.rowReader(row), right.rowReader(row)}; } //reader for one row
+}; //ends SumExpr class definition
+
+template <typename E> //declares template for operand type E
+class ScaleExpr : public MatrixExpr<ScaleExpr<E> > { //lazy multiplication of an expression by a scalar
+private: //private members only accessible within ScaleExpr class
+    typename ExprOperand<E>::type operand; //expression being scaled
+    typename E::value_type factor; //scalar factor
+
+public: //public functions available outside class definition
+    using value_type = typename E::value_type; //element type of result
+    static constexpr size_t readsPerElement = E::readsPerElement; //matrix elements read per result element
+    static constexpr size_t additionsPerElement = E::additionsPerElement; //additions per result element
+    static constexpr size_t flopsPerElement = E::flopsPerElement + 1; //arithmetic operations per result element
+
+    ScaleExpr(const E& expr, value_type scalar) : operand(expr), factor(scalar) {} //creates expression, nothing is computed yet
+
+    size_t getSize() const { return operand.getSize(); } //size of result
+
+    struct Reader { //reads one row of the scaled expression
+        typename E::Reader row; //reader for operand row
+        value_type factor; //scalar factor
+        value_type operator[](size_t col) const { return factor * row[col]; } //scales element
+    }; //ends Reader definition
+
+    Reader rowReader(size_t row) const { return Reader{operand.rowReader(row), factor}; } //reader for one row
+}; //ends ScaleExpr class definition
+
+template <typename T> //declares template for a generic type T
+class ProductExpr { //lazy alpha * A * B, evaluated by the blocked multiply straight into its destination
+private: //private members only accessible within ProductExpr class
+    const Matrix<T>& left; //left factor
+    const Matrix<T>& right; //right factor
+    T alpha; //scalar factor
+
+public: //public functions available outside class definition
+    using value_type = T; //element type of result
+
+    ProductExpr(const Matrix<T>& lhs, const Matrix<T>& rhs, T scalar = T(1)) : left(lhs), right(rhs), alpha(scalar) { //creates expression, nothing is computed yet
+        if (left.getSize() != right.getSize()) { //runs if matrices are different sizes
+            throw std::invalid_argument("Matrix sizes don't match for multiplication"); //throws error
+        } //ends if statement
+    } //ends constructor
+
+    size_t getSize() const { return left.getSize(); } //size of result
+    const Matrix<T>& getLeft() const { return left; } //left factor
+    const Matrix<T>& getRight() const { return right; } //right factor
+    T getAlpha() const { return alpha; } //scalar factor
+    bool uses(const Matrix<T>& matrix) const { return &matrix == &left || &matrix == &right; } //checks if matrix is a factor, writing it mid-multiply would corrupt the result
+}; //ends ProductExpr class definition
+
+template <typename T, typename E> //declares template for element type T and element-wise addend E
+class GemmSumExpr { //lazy alpha * A * B + addend, evaluated as one write of addend then one accumulating multiply
+private: //private members only accessible within GemmSumExpr class
+    ProductExpr<T> product; //product part
+    typename ExprOperand<E>::type addend; //element-wise part
+
+public: //public functions available outside class definition
+    using value_type = T; //element type of result
+
+    GemmSumExpr(const ProductExpr<T>& lhs, const E& rhs) : product(lhs), addend(rhs) { //creates expression, nothing is computed yet
+        if (product.getSize() != addend.getSize()) { //runs if matrices are different sizes
+            throw std::invalid_argument("Matrix sizes don't match for addition"); //throws error
+        } //ends if statement
+    } //ends constructor
+
+    size_t getSize() const { return product.getSize(); } //size of result
+    const ProductExpr<T>& getProduct() const { return product; } //product part
+    const E& getAddend() const { return addend; } //element-wise part
+}; //ends GemmSumExpr class definition
+
+template <typename T> //creates new generic type T
+class Matrix<T, 0> : public MatrixExpr<Matrix<T> > { //new class Matrix with its size chosen at run time, also the leaf of every matrix expression
+private: //private functions only accessible within Matrix class
+    size_t size; //creates Matrix size variable
+    size_t stride; //number of elements between the starts of consecutive physical rows, padded to a cache line
+    std::vector<T, PooledAllocator<T> > data; //single contiguous aligned buffer holding every row from the shared pool, empty when the matrix wraps a file mapping
+    std::vector<size_t> rowIndex; //maps each logical row to its physical row in data, lets swapRows run in O(1)
+    T* elements = nullptr; //first physical row, points into data or into a copy-on-write file mapping
+    std::shared_ptr<const MappedFile> mapping; //keeps a wrapped file mapped while this matrix uses it
+
+    template <typename E> //declares template for an element-wise expression E
+    void assignElementwise(const E& expr) { //writes expr into this matrix in one pass, matrix must already have expr's size
+        MATRIX_PROFILE_SCOPE(E::additionsPerElement > 0 ? MatrixOp::Add : MatrixOp::Scale, (E::readsPerElement + 1) * size * size * sizeof(T), E::flopsPerElement * size * size); //operand reads plus one write, counts taken from the expression
+        writeElementwise(expr); //evaluates expression
+    } //ends function
+
+    template <typename E> //declares template for an element-wise expression E
+    void writeElementwise(const E& expr) { //writes expr into this matrix in one pass without profiling, matrix must already have expr's size
+        matrixThreadPool().parallelFor(0, size, std::max<size_t>(1, 16384 / std::max<size_t>(size, 1)), [&](size_t first, size_t last) { //splits rows across threads, small matrices stay on one thread
+            for (size_t i = first; i < last; ++i) { //runs for rows in this range
+                const typename E::Reader source = expr.rowReader(i); //reader for row i of expression
+                T* out = rowData(i); //row i of this matrix
+                for (size_t j = 0; j < size; ++j) { //runs for size of matrix
+                    out[j] = source[j]; //evaluates element, reading before writing so expr may use this matrix
+                } //ends for loop
+            } //ends for loop
+        }); //ends parallel loop
+    } //ends function
+
+    void accumulateProduct(const ProductExpr<T>& product) { //adds alpha * A * B into this matrix, which must not be A or B
+        MATRIX_PROFILE_SCOPE(MatrixOp::Multiply, 3 * size * size * sizeof(T), 2 * size * size * size); //classical operation count, also for Strassen
+        addProduct(product); //multiplies
+    } //ends function
+
+    template <typename E> //declares template for the element-wise addend E
+    void assignGemmSum(const GemmSumExpr<T, E>& expr) { //writes addend then adds product on top, profiled as one multiply
+        MATRIX_PROFILE_SCOPE(MatrixOp::Multiply, (3 + E::readsPerElement + 1) * size * size * sizeof(T), 2 * size * size * size + E::flopsPerElement * size * size); //multiply plus the pass that writes the addend
+        writeElementwise(expr.getAddend()); //writes addend, which may read this matrix
+        addProduct(expr.getProduct()); //adds product on top
+    } //ends function
+
+    void addProduct(const ProductExpr<T>& product) { //adds alpha * A * B into this matrix without profiling, which must not be A or B
+        const Matrix<T>& left = product.getLeft(); //left factor
+        const Matrix<T>& right = product.getRight(); //right factor
+        const T alpha = product.getAlpha(); //scalar factor
+        if (size <= 16) { //runs for tiny matrices where packing costs more than it saves
+            for (size_t i = 0; i < size; ++i) { //runs for size of matrix
+                const T* leftRow = left.rowData(i); //row i of left factor
+                T* out = rowData(i); //row i of this matrix
+                for (size_t k = 0; k < size; ++k) { //runs for size of matrix
+                    const T scaled = alpha * leftRow[k]; //element of alpha * A
+                    const T* rightRow = right.rowData(k); //row k of right factor, read along the row
+                    for (size_t j = 0; j < size; ++j) { //runs for size of matrix
+                        out[j] += scaled * rightRow[j]; //performs matrix multiplication and adds final values to this matrix
+                    } //ends for loop
+                } //ends for loop
+            } //ends for loop
+            return; //finished
+        } //ends if statement
+        const std::vector<const T*> aRows = left.rowPointers(); //rows of left factor
+        const std::vector<const T*> bRows = right.rowPointers(); //rows of right factor
+        const std::vector<T*> cRows = rowPointers(); //rows of this matrix
+        if (getMultiplyMode() == MultiplyMode::Strassen && size > getStrassenCutoff()) { //runs if Strassen was chosen and the matrix is above the cutoff
+            strassenAccumulate(size, aRows.data(), bRows.data(), cRows.data(), alpha, getStrassenCutoff()); //recursive multiply
+            return; //finished
+        } //ends if statement
+        gemmAccumulate(size, size, size, aRows.data(), bRows.data(), cRows.data(), alpha); //packed, cache-blocked multiply
+    } //ends function
+
+    void reset(size_t n) { //makes this an n x n matrix of zeros, reusing storage when the size already matches
+        if (n == size) { //runs if storage can be kept
+            std::fill(elements, elements + size * stride, T()); //zeros every element
+            for (size_t i = 0; i < n; ++i) { //runs for size of matrix
+                rowIndex[i] = i; //puts rows back in physical order
+            } //ends for loop
+        } else { //runs if size changes
+            *this = Matrix<T>(n); //replaces storage
+        } //ends if statement
+    } //ends function
+
+public: //public functions available outside class definition
+    using value_type = T; //element type, used by matrix expressions
+    static constexpr size_t readsPerElement = 1; //a matrix leaf reads its own element
+    static constexpr size_t additionsPerElement = 0; //and does no arithmetic
+    static constexpr size_t flopsPerElement = 0; //and does no arithmetic
+
+    static size_t paddedStride(size_t n) { //rounds a row length up so every physical row starts on a cache line
+        const size_t perLine = sizeof(T) < AlignedAllocator<T>::alignment ? AlignedAllocator<T>::alignment / sizeof(T) : 1; //elements per cache line
+        return (n + perLine - 1) / perLine * perLine; //rounds n up to multiple of perLine
+    } //ends function
+    using Reader = const T*; //row reader used when a Matrix appears inside an expression
+
+    Matrix(size_t n = 0) : size(n), stride(paddedStride(n)), data(n * paddedStride(n)), rowIndex(n), elements(data.data()) { //creates zeroed matrix with contiguous storage
+        for (size_t i = 0; i < n; ++i) { //runs for size of matrix
+            rowIndex[i] = i; //logical rows start in physical order
+        } //ends for loop
+    } //ends constructor
+
+    Matrix(const Matrix<T>& other) : size(other.size), stride(other.stride), data(other.elements, other.elements + other.size * other.stride), rowIndex(other.rowIndex), elements(data.data()) {} //copies storage, a copy of a wrapped file gets its own buffer
+
+    Matrix(Matrix<T>&& other) noexcept : size(other.size), stride(other.stride), data(std::move(other.data)), rowIndex(std::move(other.rowIndex)), elements(other.elements), mapping(std::move(other.mapping)) { //steals storage
+        other.size = 0; //leaves other as an empty matrix
+        other.stride = 0; //empty matrix has no rows
+        other.elements = nullptr; //other no longer owns any elements
+    } //ends constructor
+
+    Matrix<T>& operator=(const Matrix<T>& other) { //copies storage
+        if (this != &other) { //runs unless assigning to itself
+            *this = Matrix<T>(other); //copies then moves copy in
+        } //ends if statement
+        return *this; //returns this matrix
+    } //ends operator definition
+
+    Matrix<T>& operator=(Matrix<T>&& other) noexcept { //steals storage
+        if (this != &other) { //runs unless assigning to itself
+            size = other.size; //takes size
+            stride = other.stride; //takes stride
+            data = std::move(other.data); //takes buffer
+            rowIndex = std::move(other.rowIndex); //takes row order
+            elements = other.elements; //takes element pointer
+            mapping = std::move(other.mapping); //takes file mapping, if any
+            other.size = 0; //leaves other as an empty matrix
+            other.stride = 0; //empty matrix has no rows
+            other.elements = nullptr; //other no longer owns any elements
+        } //ends if statement
+        return *this; //returns this matrix
+    } //ends operator definition
+
+    static Matrix<T> wrapMapping(std::shared_ptr<const MappedFile> file, T* first, size_t n, size_t rowStride) { //creates a matrix over rows already in a copy-on-write mapping, nothing is copied
+        Matrix<T> result; //empty matrix
+        result.size = n; //size of wrapped matrix
+        result.stride = rowStride; //stride stored in file
+        result.rowIndex.resize(n); //one entry per row
+        for (size_t i = 0; i < n; ++i) { //runs for size of matrix
+            result.rowIndex[i] = i; //rows start in file order
+        } //ends for loop
+        result.elements = first; //first row in mapping, writes go to private copies of the touched pages only
+        result.mapping = std::move(file); //keeps mapping alive
+        return result; //returns wrapped matrix
+    } //ends function
+
+    bool isMapped() const { return mapping != nullptr; } //checks if matrix reads straight from a file mapping
+
+    template <typename E> //declares template for an element-wise expression E
+    Matrix(const MatrixExpr<E>& expr) : Matrix(expr.self().getSize()) { //evaluates expression in one fused pass
+        assignElementwise(expr.self()); //writes result
+    } //ends constructor
+
+    Matrix(const ProductExpr<T>& product) : Matrix(product.getSize()) { //evaluates product straight into new matrix
+        accumulateProduct(product); //writes result
+    } //ends constructor
+
+    template <typename E> //declares template for the element-wise addend E
+    Matrix(const GemmSumExpr<T, E>& expr) : Matrix(expr.getSize()) { //evaluates A * B + addend with no temporary
+        assignGemmSum(expr); //writes addend then adds product
+    } //ends constructor
+
+    template <typename E> //declares template for an element-wise expression E
+    Matrix<T>& operator=(const MatrixExpr<E>& expr) { //assigns expression in one fused pass
+        if (expr.self().getSize() != size) { //runs if size changes, this matrix cannot be an operand then
+            *this = Matrix<T>(expr.self().getSize()); //replaces storage
+        } //ends if statement
+        assignElementwise(expr.self()); //writes result, element-wise so reading this matrix is safe
+        return *this; //returns this matrix
+    } //ends operator definition
+
+    Matrix<T>& operator=(const ProductExpr<T>& product) { //assigns product with no temporary unless this matrix is a factor
+        if (product.uses(*this)) { //runs if this matrix is A or B
+            return *this = Matrix<T>(product); //computes into temporary then moves it in
+        } //ends if statement
+        reset(product.getSize()); //zeros destination
+        accumulateProduct(product); //writes result
+        return *this; //returns this matrix
+    } //ends operator definition
+
+    template <typename E> //declares template for the element-wise addend E
+    Matrix<T>& operator=(const GemmSumExpr<T, E>& expr) { //assigns A * B + addend with no temporary unless this matrix is a factor
+        if (expr.getProduct().uses(*this)) { //runs if this matrix is A or B
+            return *this = Matrix<T>(expr); //computes into temporary then moves it in
+        } //ends if statement
+        if (expr.getSize() != size) { //runs if size changes
+            *this = Matrix<T>(expr.getSize()); //replaces storage
+        } //ends if statement
+        assignGemmSum(expr); //writes addend, which may read this matrix, then adds product
+        return *this; //returns this matrix
+    } //ends operator definition
+
+    template <typename E> //declares template for an element-wise expression E
+    Matrix<T>& operator+=(const MatrixExpr<E>& expr) { //adds expression in place
+        assignElementwise(SumExpr<Matrix<T>, E>(*this, expr.self())); //checks sizes and writes sum over this matrix
+        return *this; //returns this matrix
+    } //ends operator definition
+
+    Matrix<T>& operator+=(const ProductExpr<T>& product) { //adds alpha * A * B in place, the accumulate form of the multiply
+        if (product.getSize() != size) { //runs if matrices are different sizes
+            throw std::invalid_argument("Matrix sizes don't match for addition"); //throws error
+        } //ends if statement
+        if (product.uses(*this)) { //runs if this matrix is A or B
+            return *this += Matrix<T>(product); //computes product first so it reads the old values
+        } //ends if statement
+        accumulateProduct(product); //adds product
+        return *this; //returns this matrix
+    } //ends operator definition
+
+    Matrix<T>& operator*=(const T& scalar) { //scales every element in place
+        assignElementwise(ScaleExpr<Matrix<T> >(*this, scalar)); //writes scaled values over this matrix
+        return *this; //returns this matrix
+    } //ends operator definition
+
+    Matrix<T>& operator*=(const Matrix<T>& other) { //multiplies this matrix by other in place
+        return *this = ProductExpr<T>(*this, other); //product needs a temporary since this matrix is a factor
+    } //ends operator definition
+
+    Reader rowReader(size_t row) const { return rowData(row); } //row reader used when a Matrix appears inside an expression
+
+    size_t getSize() const { return size; } //functions gets size of matrix
+    size_t getStride() const { return stride; } //gets distance in elements between physical rows
+
+    T* rowData(size_t row) { return elements + rowIndex[row] * stride; } //unchecked pointer to first element of a logical row
+    const T* rowData(size_t row) const { return elements + rowIndex[row] * stride; } //unchecked pointer for const Matrix objects
+
+    T& operator()(size_t row, size_t col) { return rowData(row)[col]; } //unchecked fast-path element access
+    const T& operator()(size_t row, size_t col) const { return rowData(row)[col]; } //unchecked fast-path access for const Matrix objects
+
+    T& at(size_t row, size_t col) { //checked element access
+        if (row >= size || col >= size) { //runs if indices are out of range of matrix
+            throw std::out_of_range("Index out of range"); //throws error
+        } //ends if statement
+        return rowData(row)[col]; //returns element
+    } //ends function
+
+    const T& at(size_t row, size_t col) const { //checked element access for const Matrix objects
+        if (row >= size || col >= size) { //runs if indices are out of range of matrix
+            throw std::out_of_range("Index out of range"); //throws error
+        } //ends if statement
+        return rowData(row)[col]; //returns element
+    } //ends function
+
+    RowSpan<T> row(size_t index) { return RowSpan<T>(rowData(index), size); } //unchecked view of a row
+    RowSpan<const T> row(size_t index) const { return RowSpan<const T>(rowData(index), size); } //unchecked view of a row of const Matrix objects
+
+    RowSpan<T> operator[](size_t index) { //defines [] operator allowing for access to rows of matrix
+        if (index >= size) { //runs if index is of out of range of matrix
+            throw std::out_of_range("Index out of range"); //throws error
+        } //ends if statement
+        return row(index); //returns view of row of matrix
+    } //ends operator definition
+
+    // Const access operator
+    RowSpan<const T> operator[](size_t index) const { //defines [] operator allowing for access to rows of const Matrix objects
+        if (index >= size) { //runs if index is out of range of matrix
+            throw std::out_of_range("Index out of range"); //throws error
+        } //ends if statement
+        return row(index); //returns view of row of matrix
+    } //ends operator definition
+
+    std::vector<const T*> rowPointers() const { //pointers to each logical row, used by the multiply kernels
+        std::vector<const T*> rows(size); //one pointer per row
+        for (size_t i = 0; i < size; ++i) { //runs for size of matrix
+            rows[i] = rowData(i); //pointer to row i
+        } //ends for loop
+        return rows; //returns row pointers
+    } //ends function
+
+    std::vector<T*> rowPointers() { //writable pointers to each logical row
+        std::vector<T*> rows(size); //one pointer per row
+        for (size_t i = 0; i < size; ++i) { //runs for size of matrix
+            rows[i] = rowData(i); //pointer to row i
+        } //ends for loop
+        return rows; //returns row pointers
+    } //ends function
+
+    Matrix<T> multiplyNaive(const Matrix<T>& other) const { //reference i-j-k multiply, kept for checking the blocked kernel
+        if (size != other.size) { //runs if matrices are different sizes
+            throw std::invalid_argument("Matrix sizes don't match for multiplication"); //throws error
+        } //ends if statement
+        Matrix<T> result(size); //new matrix containing values of type T
+        for (size_t i = 0; i < size; ++i) { //runs for size of matrix
+            for (size_t j = 0; j < size; ++j) { //runs for size of matrix
+                for (size_t k = 0; k < size; ++k) { //runs for size of matrix
+                    result(i, j) += (*this)(i, k) * other(k, j); //performs matrix multiplication and adds final values to result matrix
+                } //ends for loop
+            } //ends for loop
+        } //ends for loop
+        return result; //returns result matrix
+    } //ends function
+
+    void display(std::ostream& out = std::cout) const { //function that displays matrices
+        MATRIX_PROFILE_SCOPE(MatrixOp::Display, size * size * sizeof(T), 0); //reads every element
+        for (size_t i = 0; i < size; ++i) { //runs for number of rows in matrix
+            for (const auto& val : row(i)) { //runs for number of values in each row
+                out << std::setw(8) << val; //prints values of matrix with proper spacing
+            } //ends loop
+            out << '\n'; //starts new line without flushing, callers flush once when they are done
+        } //ends loop
+    } //ends loop
+
+    T sumMainDiagonal() const { //function returns sum of major diagonal
+        T sum = 0; //new variable of type T set to 0
+        for (size_t i = 0; i < size; ++i) { //runs for size of matrix
+            sum += (*this)(i, i); //adds major diagonal values to sum
+        } //ends for loop
+        return sum; //returns sum of major diagonal
+    } //ends function
+
+    T sumSecondaryDiagonal() const { //function returns sum of minor diagonal
+        T sum = 0; //new variable of type T set to 0
+        for (size_t i = 0; i < size; ++i) { //runs for size of matrix
+            sum += (*this)(i, size - 1 - i); //adds minor diagonal values to sum
+        } //ends for loop
+        return sum; //returns sum of minor diagonal
+    } //ends function
+
+    void swapRows(size_t row1, size_t row2) { //function swaps rows in a matrix
+        MATRIX_PROFILE_SCOPE(MatrixOp::SwapRows, 4 * sizeof(size_t), 0); //reads and writes two index entries
+        if (row1 >= size || row2 >= size) { //checks if rows are within size of matrix
+            throw std::out_of_range("Row index out of range"); //throws error
+        } //ends if statement
+        std::swap(rowIndex[row1], rowIndex[row2]); //swaps which physical rows the two logical rows point at, no data is moved
+    } //ends function
+
+    void swapColumns(size_t col1, size_t col2) { //function swaps cols in a matrix
+        MATRIX_PROFILE_SCOPE(MatrixOp::SwapColumns, 4 * size * sizeof(T), 0); //reads and writes two elements per row
+        if (col1 >= size || col2 >= size) { //checks if cols are within size of matrix
+            throw std::out_of_range("Column index out of range"); //throws error
+        } //ends if statement
+        for (size_t i = 0; i < size; ++i) { //runs for size of matrix
+            T* rowPointer = rowData(i); //row i of matrix
+            std::swap(rowPointer[col1], rowPointer[col2]); //swaps cols index by index
+        } //ends for loop
+    } //ends function
+
+    void updateElement(size_t row, size_t col, T value) { //function takes two indices and a value, replaces value at indices with value
+        MATRIX_PROFILE_SCOPE(MatrixOp::Update, sizeof(T), 0); //writes one element
+        if (row >= size || col >= size) { //checks if given sets of indices is out of bounds of matrix
+            throw std::out_of_range("Index out of range"); //throws error
+        } //ends if statement
+        (*this)(row, col) = value; //replaces value at row/col with value
+    } //ends function
+}; //ends Matrix class definition
+
+template <typename L, typename R> //declares template for left and right expression types
+SumExpr<L, R> operator+(const MatrixExpr<L>& lhs, const MatrixExpr<R>& rhs) { //overloads + operator, returns lazy sum of matrices or expressions
+    return SumExpr<L, R>(lhs.self(), rhs.self()); //builds expression, computed when assigned to a Matrix
+} //ends operator overload
+
+template <typename T, typename E> //declares template for element type T and expression type E
+Matrix<T> operator+(Matrix<T>&& lhs, const MatrixExpr<E>& rhs) { //adding to a temporary Matrix reuses its storage
+    lhs += rhs; //adds in place
+    return std::move(lhs); //moves storage into result
+} //ends operator overload
+
+template <typename E> //declares template for an expression type E
+ScaleExpr<E> operator*(const typename E::value_type& scalar, const MatrixExpr<E>& expr) { //overloads * operator for scalar times matrix
+    return ScaleExpr<E>(expr.self(), scalar); //builds expression
+} //ends operator overload
+
+template <typename E> //declares template for an expression type E
+ScaleExpr<E> operator*(const MatrixExpr<E>& expr, const typename E::value_type& scalar) { //overloads * operator for matrix times scalar
+    return ScaleExpr<E>(expr.self(), scalar); //builds expression
+} //ends operator overload
+
+template <typename T> //declares template for a generic type T
+ProductExpr<T> operator*(const Matrix<T>& lhs, const Matrix<T>& rhs) { //overloads * operator allowing for matrix multiplication, evaluated when assigned
+    return ProductExpr<T>(lhs, rhs); //builds expression
+} //ends operator overload
+
+template <typename T> //declares template for a generic type T
+ProductExpr<T> operator*(const T& scalar, const ProductExpr<T>& product) { //scalar times product folds into the multiply
+    return ProductExpr<T>(product.getLeft(), product.getRight(), scalar * product.getAlpha()); //builds expression
+} //ends operator overload
+
+template <typename T> //declares template for a generic type T
+ProductExpr<T> operator*(const ProductExpr<T>& product, const T& scalar) { //product times scalar folds into the multiply
+    return ProductExpr<T>(product.getLeft(), product.getRight(), product.getAlpha() * scalar); //builds expression
+} //ends operator overload
+
+template <typename T, typename E> //declares template for element type T and expression type E
+GemmSumExpr<T, E> operator+(const ProductExpr<T>& product, const MatrixExpr<E>& addend) { //A * B + C, fused into one accumulating multiply
+    return GemmSumExpr<T, E>(product, addend.self()); //builds expression
+} //ends operator overload
+
+template <typename T, typename E> //declares template for element type T and expression type E
+GemmSumExpr<T, E> operator+(const MatrixExpr<E>& addend, const ProductExpr<T>& product) { //C + A * B, fused into one accumulating multiply
+    return GemmSumExpr<T, E>(product, addend.self()); //builds expression
+} //ends operator overload
+
+template <typename T> //declares template for a generic type T
+Matrix<T> operator+(const ProductExpr<T>& lhs, const ProductExpr<T>& rhs) { //A * B + C * D, second product accumulates into the first
+    Matrix<T> result(lhs); //evaluates first product
+    result += rhs; //accumulates second product
+    return result; //returns result matrix
+} //ends operator overload
+
+template <typename L, typename R> //declares template for left and right expression types
+Matrix<typename L::value_type> operator*(const MatrixExpr<L>& lhs, const MatrixExpr<R>& rhs) { //product of expressions, e.g. (A + B) * C, evaluates operands first
+    const Matrix<typename L::value_type> left(lhs); //evaluates left operand
+    const Matrix<typename L::value_type> right(rhs); //evaluates right operand
+    return Matrix<typename L::value_type>(left * right); //multiplies evaluated operands
+} //ends operator overload
+
+template <typename T> //declares template for a generic type T
+Matrix<T> operator*(const ProductExpr<T>& lhs, const Matrix<T>& rhs) { //chained product, e.g. A * B * C
+    const Matrix<T> left(lhs); //evaluates first product
+    return Matrix<T>(left * rhs); //multiplies by right operand
+} //ends operator overload
+
+template <typename T> //declares template for a generic type T
+Matrix<T> operator*(const Matrix<T>& lhs, const ProductExpr<T>& rhs) { //chained product, e.g. A * (B * C)
+    const Matrix<T> right(rhs); //evaluates second product
+    return Matrix<T>(lhs * right); //multiplies by left operand
+} //ends operator overload
+
+template <typename T, size_t N> //declares template for element type T and compile-time size N, N = 0 is the runtime-sized Matrix<T> above
+class Matrix { //fixed N x N matrix with inline storage, same interface as Matrix<T> but no heap, no row index and unrolled arithmetic
+private: //private members only accessible within Matrix class
+    std::array<T, N * N> values; //elements in row order
+
+    template <size_t... I> //declares template for every element index
+    static constexpr Matrix sumOf(const Matrix& a, const Matrix& b, std::index_sequence<I...>) { //unrolled element-wise sum
+        return Matrix(std::array<T, N * N>{{(a.values[I] + b.values[I])...}}); //one add per element, no loop
+    } //ends function
+
+    template <size_t I, size_t... K> //declares template for one result element and every inner index
+    static constexpr T productElement(const Matrix& a, const Matrix& b, std::index_sequence<K...>) { //unrolled dot product of row I / N of a and col I % N of b
+        return (T() + ... + (a.values[I / N * N + K] * b.values[K * N + I % N])); //adds products in order k = 0, 1, ...
+    } //ends function
+
+    template <size_t... I> //declares template for every element index
+    static constexpr Matrix productOf(const Matrix& a, const Matrix& b, std::index_sequence<I...>) { //unrolled product
+        return Matrix(std::array<T, N * N>{{productElement<I>(a, b, std::make_index_sequence<N>())...}}); //one dot product per element, no loop
+    } //ends function
+
+    template <size_t... I> //declares template for every diagonal index
+    constexpr T mainDiagonal(std::index_sequence<I...>) const { return (T() + ... + values[I * N + I]); } //unrolled major diagonal sum
+    template <size_t... I> //declares template for every diagonal index
+    constexpr T secondaryDiagonal(std::index_sequence<I...>) const { return (T() + ... + values[I * N + N - 1 - I]); } //unrolled minor diagonal sum
+
+public: //public functions available outside class definition
+    static_assert(N > 0, "Matrix<T, 0> is the runtime-sized matrix"); //size 0 never reaches this template
+    using value_type = T; //element type
+
+    constexpr Matrix(size_t n = N) : values{} { //creates zeroed matrix, n is only accepted if it equals N so Matrix<T>(size)-style code compiles
+        if (n != N) { //runs if a runtime size disagrees with the fixed size
+            throw std::invalid_argument("Matrix size doesn't match fixed size"); //throws error
+        } //ends if statement
+    } //ends constructor
+
+    explicit constexpr Matrix(const std::array<T, N * N>& elements) : values(elements) {} //creates matrix from elements in row order
+
+    explicit Matrix(const Matrix<T>& other) : values{} { //copies a runtime-sized matrix of the same size
+        if (other.getSize() != N) { //runs if sizes differ
+            throw std::invalid_argument("Matrix size doesn't match fixed size"); //throws error
+        } //ends if statement
+        for (size_t i = 0; i < N; ++i) { //runs for size of matrix
+            std::copy(other.rowData(i), other.rowData(i) + N, values.begin() + i * N); //copies row i
+        } //ends for loop
+    } //ends constructor
+
+    Matrix<T> toDynamic() const { //function copies into a runtime-sized matrix
+        Matrix<T> result(N); //runtime-sized matrix
+        for (size_t i = 0; i < N; ++i) { //runs for size of matrix
+            std::copy(rowData(i), rowData(i) + N, result.rowData(i)); //copies row i
+        } //ends for loop
+        return result; //returns copy
+    } //ends function
+
+    static constexpr size_t getSize() { return N; } //functions gets size of matrix
+    constexpr T* rowData(size_t row) { return values.data() + row * N; } //unchecked pointer to first element of a row
+    constexpr const T* rowData(size_t row) const { return values.data() + row * N; } //unchecked pointer for const Matrix objects
+    constexpr T& operator()(size_t row, size_t col) { return values[row * N + col]; } //unchecked fast-path access
+    constexpr const T& operator()(size_t row, size_t col) const { return values[row * N + col]; } //unchecked fast-path access for const Matrix objects
+
+    T& at(size_t row, size_t col) { //checked element access
+        if (row >= N || col >= N) { //runs if indices are out of range of matrix
+            throw std::out_of_range("Index out of range"); //throws error
+        } //ends if statement
+        return values[row * N + col]; //returns element
+    } //ends function
+
+    const T& at(size_t row, size_t col) const { //checked element access for const Matrix objects
+        if (row >= N || col >= N) { //runs if indices are out of range of matrix
+            throw std::out_of_range("Index out of range"); //throws error
+        } //ends if statement
+        return values[row * N + col]; //returns element
+    } //ends function
+
+    RowSpan<T> row(size_t index) { return RowSpan<T>(rowData(index), N); } //unchecked view of a row
+    RowSpan<const T> row(size_t index) const { return RowSpan<const T>(rowData(index), N); } //unchecked view of a row of const Matrix objects
+
+    RowSpan<T> operator[](size_t index) { //defines [] operator allowing for access to rows of matrix
+        if (index >= N) { //runs if index is of out of range of matrix
+            throw std::out_of_range("Index out of range"); //throws error
+        } //ends if statement
+        return row(index); //returns view of row of matrix
+    } //ends operator definition
+
+    RowSpan<const T> operator[](size_t index) const { //defines [] operator allowing for access to rows of const Matrix objects
+        if (index >= N) { //runs if index is out of range of matrix
+            throw std::out_of_range("Index out of range"); //throws error
+        } //ends if statement
+        return row(index); //returns view of row of matrix
+    } //ends operator definition
+
+    //+, * and the diagonal sums are constexpr, so they cannot hold a profiling scope and are not profiled, use MatrixBatch for profiled bulk work
+    constexpr Matrix operator+(const Matrix& other) const { return sumOf(*this, other, std::make_index_sequence<N * N>()); } //overloads + operator, sizes always match
+    constexpr Matrix operator*(const Matrix& other) const { return productOf(*this, other, std::make_index_sequence<N * N>()); } //overloads * operator, sizes always match
+    constexpr T sumMainDiagonal() const { return mainDiagonal(std::make_index_sequence<N>()); } //function returns sum of major diagonal
+    constexpr T sumSecondaryDiagonal() const { return secondaryDiagonal(std::make_index_sequence<N>()); } //function returns sum of minor diagonal
+
+    void display(std::ostream& out = std::cout) const { //function that displays matrices, same layout as Matrix<T>
+        MATRIX_PROFILE_SCOPE(MatrixOp::Display, N * N * sizeof(T), 0); //reads every element
+        for (size_t i = 0; i < N; ++i) { //runs for number of rows in matrix
+            for (size_t j = 0; j < N; ++j) { //runs for number of values in each row
+                out << std::setw(8) << values[i * N + j]; //prints values of matrix with proper spacing
+            } //ends loop
+            out << '\n'; //starts new line without flushing
+        } //ends loop
+    } //ends function
+
+    void swapRows(size_t row1, size_t row2) { //function swaps rows in a matrix
+        MATRIX_PROFILE_SCOPE(MatrixOp::SwapRows, 4 * N * sizeof(T), 0); //reads and writes both rows
+        if (row1 >= N || row2 >= N) { //checks if rows are within size of matrix
+            throw std::out_of_range("Row index out of range"); //throws error
+        } //ends if statement
+        std::swap_ranges(rowData(row1), rowData(row1) + N, rowData(row2)); //rows are short, so elements are moved
+    } //ends function
+
+    void swapColumns(size_t col1, size_t col2) { //function swaps cols in a matrix
+        MATRIX_PROFILE_SCOPE(MatrixOp::SwapColumns, 4 * N * sizeof(T), 0); //reads and writes two elements per row
+        if (col1 >= N || col2 >= N) { //checks if cols are within size of matrix
+            throw std::out_of_range("Column index out of range"); //throws error
+        } //ends if statement
+        for (size_t i = 0; i < N; ++i) { //runs for size of matrix
+            std::swap(values[i * N + col1], values[i * N + col2]); //swaps cols index by index
+        } //ends for loop
+    } //ends function
+
+    void updateElement(size_t row, size_t col, T value) { //function takes two indices and a value, replaces value at indices with value
+        MATRIX_PROFILE_SCOPE(MatrixOp::Update, sizeof(T), 0); //writes one element
+        if (row >= N || col >= N) { //checks if given sets of indices is out of bounds of matrix
+            throw std::out_of_range("Index out of range"); //throws error
+        } //ends if statement
+        values[row * N + col] = value; //replaces value at row/col with value
+    } //ends function
+}; //ends fixed-size Matrix class definition
+
+template <typename T, size_t N> //declares template for element type T and compile-time size N
+class MatrixBatch { //many N x N matrices in blocked structure-of-arrays form, so batched loops run across matrices in SIMD lanes
+private: //private members only accessible within MatrixBatch class
+    size_t count; //number of matrices
+    std::vector<T, PooledAllocator<T> > values; //element e of matrix m at values[((m / lanes) * N * N + e) * lanes + m % lanes]
+
+public: //public functions available outside class definition
+    using value_type = T; //element type
+    static constexpr size_t lanes = 256 / sizeof(T); //matrices per block, each element of a block fills a few cache lines and the block stays contiguous for streaming
+    static constexpr size_t blockElements = N * N * lanes; //elements in one block
+
+    explicit MatrixBatch(size_t n = 0) : count(n), values((n + lanes - 1) / lanes * blockElements) {} //creates n zeroed matrices, the last block is zero padded
+
+    size_t size() const { return count; } //function returns number of matrices
+    size_t blocks() const { return (count + lanes - 1) / lanes; } //function returns number of blocks
+    T* block(size_t index) { return values.data() + index * blockElements; } //first element of a block, unchecked
+    const T* block(size_t index) const { return values.data() + index * blockElements; } //first element of a block for const batches, unchecked
+
+    Matrix<T, N> get(size_t index) const { //function copies one matrix out of the batch
+        if (index >= count) { //runs if index is out of range of batch
+            throw std::out_of_range("Index out of range"); //throws error
+        } //ends if statement
+        const T* source = block(index / lanes) + index % lanes; //element 0 of this matrix
+        Matrix<T, N> result; //fixed-size matrix
+        for (size_t e = 0; e < N * N; ++e) { //runs for each element
+            result(e / N, e % N) = source[e * lanes]; //gathers element
+        } //ends for loop
+        return result; //returns matrix
+    } //ends function
+
+    void set(size_t index, const Matrix<T, N>& matrix) { //function copies one matrix into the batch
+        if (index >= count) { //runs if index is out of range of batch
+            throw std::out_of_range("Index out of range"); //throws error
+        } //ends if statement
+        T* target = block(index / lanes) + index % lanes; //element 0 of this matrix
+        for (size_t e = 0; e < N * N; ++e) { //runs for each element
+            target[e * lanes] = matrix(e / N, e % N); //scatters element
+        } //ends for loop
+    } //ends function
+}; //ends MatrixBatch class definition
+
+template <typename T, size_t N> //declares template for element type T and compile-time size N
+inline __attribute__((always_inline)) void multiplyBatchBlocks(const T* __restrict a, const T* __restrict b, T* __restrict c, size_t first, size_t last) { //c = a * b for blocks [first, last), inner loops run across the lanes of a block
+    constexpr size_t L = MatrixBatch<T, N>::lanes; //matrices per block
+    constexpr size_t blockElements = MatrixBatch<T, N>::blockElements; //elements per block
+    for (size_t blockIndex = first; blockIndex < last; ++blockIndex) { //runs for each block
+        const T* x = a + blockIndex * blockElements; //left block
+        const T* y = b + blockIndex * blockElements; //right block
+        T* z = c + blockIndex * blockElements; //result block
+        for (size_t i = 0; i < N; ++i) { //runs for rows of result
+            for (size_t j = 0; j < N; ++j) { //runs for cols of result
+                T* out = z + (i * N + j) * L; //element (i, j) of every result in block
+                for (size_t m = 0; m < L; ++m) { //runs across lanes, fixed count so it vectorizes with no remainder
+                    out[m] = x[(i * N) * L + m] * y[j * L + m]; //first term
+                } //ends for loop
+                for (size_t k = 1; k < N; ++k) { //runs for remaining terms, in the same order as Matrix<T, N>::operator*
+                    for (size_t m = 0; m < L; ++m) { //runs across lanes
+                        out[m] += x[(i * N + k) * L + m] * y[(k * N + j) * L + m]; //adds term
+                    } //ends for loop
+                } //ends for loop
+            } //ends for loop
+        } //ends for loop
+    } //ends for loop
+} //ends function
+
+template <typename T, size_t N> //declares template for element type T and compile-time size N
+using BatchKernel = void (*)(const T*, const T*, T*, size_t, size_t); //signature of a batched multiply kernel
+
+template <typename T, size_t N> //declares template for element type T and compile-time size N
+void multiplyBatchPortable(const T* a, const T* b, T* c, size_t first, size_t last) { multiplyBatchBlocks<T, N>(a, b, c, first, last); } //baseline instruction set
+
+#ifdef MATRIX_HAVE_X86_KERNELS //only x86 has SIMD kernels
+template <typename T, size_t N> //declares template for element type T and compile-time size N
+__attribute__((target("avx2"))) void multiplyBatchAvx2(const T* a, const T* b, T* c, size_t first, size_t last) { multiplyBatchBlocks<T, N>(a, b, c, first, last); } //same loops compiled for 256-bit registers
+template <typename T, size_t N> //declares template for element type T and compile-time size N
+__attribute__((target("avx512f"))) void multiplyBatchAvx512(const T* a, const T* b, T* c, size_t first, size_t last) { multiplyBatchBlocks<T, N>(a, b, c, first, last); } //same loops compiled for 512-bit registers
+#endif //ends preprocessor check
+
+template <typename T, size_t N> //declares template for element type T and compile-time size N
+BatchKernel<T, N> selectBatchKernel() { //function picks the batched multiply for this CPU
+#ifdef MATRIX_HAVE_X86_KERNELS //only x86 has SIMD kernels
+    switch (activeSimdLevel()) { //switch on detected instruction set
+        case SimdLevel::Avx512: return &multiplyBatchAvx512<T, N>; //512-bit loops
+        case SimdLevel::Avx2: return &multiplyBatchAvx2<T, N>; //256-bit loops
+        case SimdLevel::Portable: break; //falls through to baseline loops
+    } //ends switch block
+#endif //ends preprocessor check
+    return &multiplyBatchPortable<T, N>; //baseline loops
+} //ends function
+
+template <typename T, size_t N> //declares template for element type T and compile-time size N
+void multiplyBatch(const MatrixBatch<T, N>& lhs, const MatrixBatch<T, N>& rhs, MatrixBatch<T, N>& result) { //result[m] = lhs[m] * rhs[m] for every matrix in the batches, same summation order as Matrix<T, N>::operator*, floating results may differ in the last bit where the SIMD build fuses multiply-adds
+    if (lhs.size() != rhs.size()) { //runs if batches are different sizes
+        throw std::invalid_argument("Batch sizes don't match for multiplication"); //throws error
+    } //ends if statement
+    if (&result == &lhs || &result == &rhs) { //runs if result would overwrite an operand while it is read
+        throw std::invalid_argument("Batch result must not be an operand"); //throws error
+    } //ends if statement
+    if (result.size() != lhs.size()) { //runs if result has the wrong size
+        result = MatrixBatch<T, N>(lhs.size()); //resizes result
+    } //ends if statement
+    MATRIX_PROFILE_SCOPE(MatrixOp::Multiply, 3 * N * N * lhs.size() * sizeof(T), 2 * N * N * N * lhs.size()); //counted like one multiply per matrix
+    const BatchKernel<T, N> kernel = selectBatchKernel<T, N>(); //loops for this CPU
+    const T* a = lhs.block(0); //left elements
+    const T* b = rhs.block(0); //right elements
+    T* c = result.block(0); //result elements
+    matrixThreadPool().parallelFor(0, lhs.blocks(), std::max<size_t>(1, 65536 / MatrixBatch<T, N>::blockElements), [&](size_t first, size_t last) { //splits blocks across threads, a few hundred KiB per chunk
+        kernel(a, b, c, first, last); //multiplies blocks
+    }); //ends parallel loop
+} //ends function
+
+template <typename T, size_t N> //declares template for element type T and compile-time size N
+void addBatch(const MatrixBatch<T, N>& lhs, const MatrixBatch<T, N>& rhs, MatrixBatch<T, N>& result) { //result[m] = lhs[m] + rhs[m] for every matrix in the batches, result may be an operand
+    if (lhs.size() != rhs.size()) { //runs if batches are different sizes
+        throw std::invalid_argument("Batch sizes don't match for addition"); //throws error
+    } //ends if statement
+    if (result.size() != lhs.size()) { //runs if result has the wrong size
+        result = MatrixBatch<T, N>(lhs.size()); //resizes result
+    } //ends if statement
+    MATRIX_PROFILE_SCOPE(MatrixOp::Add, 3 * N * N * lhs.size() * sizeof(T), N * N * lhs.size()); //counted like one add per matrix
+    const size_t total = lhs.blocks() * MatrixBatch<T, N>::blockElements; //elements including padding, which is zero in both operands
+    const T* a = lhs.block(0); //left elements
+    const T* b = rhs.block(0); //right elements
+    T* c = result.block(0); //result elements
+    matrixThreadPool().parallelFor(0, total, 65536, [&](size_t first, size_t last) { //splits elements across threads
+        for (size_t e = first; e < last; ++e) { //runs for elements in this range
+            c[e] = a[e] + b[e]; //element-wise sum, one flat loop
+        } //ends for loop
+    }); //ends parallel loop
+} //ends function
+
+template <typename T> //declares template for a generic type T
+class TrackedMatrix { //matrix whose row, column and diagonal sums and product with a fixed right operand are kept up to date under swaps and updates
+private: //private members only accessible within TrackedMatrix class
+    struct PendingEdit { //change to the left matrix not yet applied to the cached product
+        enum Kind { Update, SwapRows, SwapColumns } kind; //type of change
+        size_t first, second; //row and col for Update, the two indices for swaps
+        T delta; //new value minus old value for Update
+        std::vector<T> columnDifference; //A(i, second) - A(i, first) before a column swap, one per row
+    }; //ends PendingEdit definition
+
+    Matrix<T> matrix; //left matrix, only changed through this class
+    Matrix<T> right; //right operand of the cached product
+    Matrix<T> cachedProduct; //matrix * right, valid when productValid is set and pending is applied
+    bool hasRight = false; //true once a right operand is set
+    bool productValid = false; //true if cachedProduct plus pending edits equals matrix * right
+    std::vector<PendingEdit> pending; //changes since cachedProduct was last brought up to date
+    size_t pendingCost = 0; //element updates needed to apply pending
+    std::vector<T> rowSums; //sum of each row
+    std::vector<T> columnSums; //sum of each col
+    T mainSum = T(); //sum of major diagonal
+    T secondarySum = T(); //sum of minor diagonal
+
+    void addPending(PendingEdit edit, size_t cost) { //function queues a change for the cached product, or drops the cache if patching would cost more than a multiply
+        if (!productValid) { //runs if there is no product to patch
+            return; //product is rebuilt on next use
+        } //ends if statement
+        const size_t n = matrix.getSize(); //size of matrix
+        pendingCost += cost; //work to apply queue
+        if (pendingCost > n * n * n / 8) { //runs if patching is no longer cheaper than multiplying again
+            productValid = false; //rebuilds product on next use
+            pending.clear(); //drops queued changes
+            pendingCost = 0; //nothing queued
+            return; //finished
+        } //ends if statement
+        pending.push_back(std::move(edit)); //queues change
+    } //ends function
+
+    void applyPending() { //function patches the cached product with every queued change, in order
+        const size_t n = matrix.getSize(); //size of matrix
+        for (const PendingEdit& edit : pending) { //runs for each queued change
+            if (edit.kind == PendingEdit::SwapRows) { //runs for row swap
+                cachedProduct.swapRows(edit.first, edit.second); //rows of A * B swap with rows of A
+            } else if (edit.kind == PendingEdit::Update) { //runs for element update
+                T* out = cachedProduct.rowData(edit.first); //only this row of A * B changes
+                const T* source = right.rowData(edit.second); //row of B matching the updated col
+                for (size_t j = 0; j < n; ++j) { //runs for size of matrix
+                    out[j] += edit.delta * source[j]; //rank-1 update of one row
+                } //ends for loop
+            } else { //runs for column swap, A * B changes by d (B(first) - B(second)) with d the old col difference
+                std::vector<T> rowDifference(n); //B(first) - B(second)
+                const T* row1 = right.rowData(edit.first); //row of B for first col
+                const T* row2 = right.rowData(edit.second); //row of B for second col
+                for (size_t j = 0; j < n; ++j) { //runs for size of matrix
+                    rowDifference[j] = row1[j] - row2[j]; //difference of rows
+                } //ends for loop
+                matrixThreadPool().parallelFor(0, n, std::max<size_t>(1, 16384 / std::max<size_t>(n, 1)), [&](size_t first, size_t last) { //splits rows across threads
+                    for (size_t i = first; i < last; ++i) { //runs for rows in this range
+                        const T scale = edit.columnDifference[i]; //old A(i, second) - A(i, first)
+                        if (scale == T()) { //runs if row is unchanged by the swap
+                            continue; //nothing to add
+                        } //ends if statement
+                        T* out = cachedProduct.rowData(i); //row i of A * B
+                        for (size_t j = 0; j < n; ++j) { //runs for size of matrix
+                            out[j] += scale * rowDifference[j]; //rank-1 update
+                        } //ends for loop
+                    } //ends for loop
+                }); //ends parallel loop
+            } //ends if statement
+        } //ends for loop
+        pending.clear(); //queue applied
+        pendingCost = 0; //nothing queued
+    } //ends function
+
+public: //public functions available outside class definition
+    explicit TrackedMatrix(Matrix<T> source = Matrix<T>()) : matrix(std::move(source)) { //takes a matrix and computes its sums once
+        refresh(); //computes sums
+    } //ends constructor
+
+    void refresh() { //function recomputes every sum from the elements, clears floating point drift from many small edits
+        const size_t n = matrix.getSize(); //size of matrix
+        rowSums.assign(n, T()); //zeros row sums
+        columnSums.assign(n, T()); //zeros col sums
+        mainSum = matrix.sumMainDiagonal(); //major diagonal
+        secondarySum = matrix.sumSecondaryDiagonal(); //minor diagonal
+        for (size_t i = 0; i < n; ++i) { //runs for size of matrix
+            const T* row = matrix.rowData(i); //row i
+            for (size_t j = 0; j < n; ++j) { //runs for size of matrix
+                rowSums[i] += row[j]; //adds to row sum
+                columnSums[j] += row[j]; //adds to col sum
+            } //ends for loop
+        } //ends for loop
+    } //ends function
+
+    void setRightOperand(const Matrix<T>& other) { //function sets B for product(), which is rebuilt on next use
+        if (other.getSize() != matrix.getSize()) { //runs if matrices are different sizes
+            throw std::invalid_argument("Matrix sizes don't match for multiplication"); //throws error
+        } //ends if statement
+        right = other; //copies operand so later changes to other do not affect the cache
+        hasRight = true; //product can be formed
+        productValid = false; //old product no longer applies
+        pending.clear(); //drops queued changes
+        pendingCost = 0; //nothing queued
+    } //ends function
+
+    const Matrix<T>& product() { //function returns matrix * right, patching the cached product when that is cheaper than multiplying again
+        if (!hasRight) { //runs if no right operand was set
+            throw std::logic_error("No right operand set for product"); //throws error
+        } //ends if statement
+        if (!productValid) { //runs if cache is empty or was dropped
+            cachedProduct = matrix * right; //full multiply
+            productValid = true; //cache matches matrix
+            pending.clear(); //nothing to apply
+            pendingCost = 0; //nothing queued
+        } else { //runs if cache can be patched
+            applyPending(); //brings cache up to date
+        } //ends if statement
+        return cachedProduct; //returns product
+    } //ends function
+
+    const Matrix<T>& get() const { return matrix; } //function returns the tracked matrix, read only so sums stay correct
+    size_t getSize() const { return matrix.getSize(); } //functions gets size of matrix
+
+    T sumMainDiagonal() const { return mainSum; } //function returns sum of major diagonal in O(1)
+    T sumSecondaryDiagonal() const { return secondarySum; } //function returns sum of minor diagonal in O(1)
+    T trace() const { return mainSum; } //function returns trace, the same as the major diagonal sum
+
+    T rowSum(size_t row) const { //function returns sum of a row in O(1)
+        if (row >= rowSums.size()) { //checks if row is within size of matrix
+            throw std::out_of_range("Row index out of range"); //throws error
+        } //ends if statement
+        return rowSums[row]; //returns kept sum
+    } //ends function
+
+    T columnSum(size_t col) const { //function returns sum of a col in O(1)
+        if (col >= columnSums.size()) { //checks if col is within size of matrix
+            throw std::out_of_range("Column index out of range"); //throws error
+        } //ends if statement
+        return columnSums[col]; //returns kept sum
+    } //ends function
+
+    void swapRows(size_t row1, size_t row2) { //function swaps rows, O(1) sums and product
+        const size_t n = matrix.getSize(); //size of matrix
+        if (row1 >= n || row2 >= n) { //checks if rows are within size of matrix
+            throw std::out_of_range("Row index out of range"); //throws error
+        } //ends if statement
+        if (row1 == row2) { //runs if rows are the same
+            return; //nothing changes
+        } //ends if statement
+        const size_t minor1 = n - 1 - row1, minor2 = n - 1 - row2; //cols of minor diagonal in each row
+        mainSum += matrix(row2, row1) + matrix(row1, row2) - matrix(row1, row1) - matrix(row2, row2); //diagonal elements the rows bring with them
+        secondarySum += matrix(row2, minor1) + matrix(row1, minor2) - matrix(row1, minor1) - matrix(row2, minor2); //same for minor diagonal
+        std::swap(rowSums[row1], rowSums[row2]); //row sums move with rows, col sums are unchanged
+        matrix.swapRows(row1, row2); //swaps rows
+        addPending(PendingEdit{PendingEdit::SwapRows, row1, row2, T(), {}}, 1); //product rows swap too
+    } //ends function
+
+    void swapColumns(size_t col1, size_t col2) { //function swaps cols, O(1) sums and an O(n^2) rank-1 product patch
+        const size_t n = matrix.getSize(); //size of matrix
+        if (col1 >= n || col2 >= n) { //checks if cols are within size of matrix
+            throw std::out_of_range("Column index out of range"); //throws error
+        } //ends if statement
+        if (col1 == col2) { //runs if cols are the same
+            return; //nothing changes
+        } //ends if statement
+        const size_t minor1 = n - 1 - col1, minor2 = n - 1 - col2; //rows whose minor diagonal element is in each col
+        mainSum += matrix(col1, col2) + matrix(col2, col1) - matrix(col1, col1) - matrix(col2, col2); //diagonal elements the cols bring with them
+        secondarySum += matrix(minor1, col2) + matrix(minor2, col1) - matrix(minor1, col1) - matrix(minor2, col2); //same for minor diagonal
+        std::swap(columnSums[col1], columnSums[col2]); //col sums move with cols, row sums are unchanged
+        PendingEdit edit{PendingEdit::SwapColumns, col1, col2, T(), {}}; //product change
+        if (productValid) { //runs if a cached product will need patching
+            edit.columnDifference.resize(n); //one difference per row
+            for (size_t i = 0; i < n; ++i) { //runs for size of matrix
+                edit.columnDifference[i] = matrix(i, col2) - matrix(i, col1); //difference before swap
+            } //ends for loop
+        } //ends if statement
+        matrix.swapColumns(col1, col2); //swaps cols
+        addPending(std::move(edit), n * n); //queues product patch
+    } //ends function
+
+    void updateElement(size_t row, size_t col, T value) { //function replaces one element, O(1) sums and an O(n) rank-1 product patch
+        const size_t n = matrix.getSize(); //size of matrix
+        if (row >= n || col >= n) { //checks if given sets of indices is out of bounds of matrix
+            throw std::out_of_range("Index out of range"); //throws error
+        } //ends if statement
+        const T delta = value - matrix(row, col); //change in element
+        rowSums[row] += delta; //row sum changes by delta
+        columnSums[col] += delta; //col sum changes by delta
+        if (row == col) { //runs if element is on major diagonal
+            mainSum += delta; //diagonal sum changes by delta
+        } //ends if statement
+        if (row + col == n - 1) { //runs if element is on minor diagonal
+            secondarySum += delta; //diagonal sum changes by delta
+        } //ends if statement
+        matrix.updateElement(row, col, value); //replaces element
+        addPending(PendingEdit{PendingEdit::Update, row, col, delta, {}}, n); //product row changes by delta times row col of B
+    } //ends function
+}; //ends TrackedMatrix class definition
+
+template <typename T> //declares template for a generic type T
+void loadMatricesFromStream(const std::string& filename, Matrix<T>& matrix1, Matrix<T>& matrix2) { //function generates two matrices from a file using iostreams, kept for inputs that cannot be memory mapped
+    std::ifstream file(filename); //opens file with name filename
+    if (!file.is_open()) { //checks if file opens
+        throw std::runtime_error("Failed to open file"); //throws error
+    } //ends if statement
+
+    size_t size; //creates size_T size
+    int typeFlag; //creates int typeFlag representing type of matrices
+    file >> size >> typeFlag; //sets first value in file to size, second value to typeFlag
+
+    matrix1 = Matrix<T>(size); //creates new Matrix with type T called matrix1
+    matrix2 = Matrix<T>(size); //creates new Matrix with type T called matrix2
+
+    for (size_t i = 0; i < size; ++i) { //runs for size of matrix1
+        for (size_t j = 0; j < size; ++j) { //runs for size of matrix1
+            file >> matrix1[i][j]; //fills matrix1 with values from file
+        } //ends loop
+    } //ends loop
+
+    for (size_t i = 0; i < size; ++i) { //runs for size of matrix2
+        for (size_t j = 0; j < size; ++j) { //runs for size of matrix2
+            file >> matrix2[i][j]; //fills matrix2 with values from file
+        } //ends loop
+    } //ends loop
+} //ends function
+
+class MappedFile { //read-only memory mapping of a whole file, unmapped when destroyed
+private: //private members only accessible within MappedFile class
+    char* bytes = nullptr; //start of mapping, null for empty files
+    size_t length = 0; //size of file in bytes
+    bool copyOnWrite = false; //true if pages may be written, writes stay private to this process
+
+public: //public functions available outside class definition
+    explicit MappedFile(const std::string& filename, bool writable = false) : copyOnWrite(writable) { //maps file with name filename, read-only or copy-on-write
+        const int descriptor = ::open(filename.c_str(), O_RDONLY); //opens file
+        if (descriptor < 0) { //checks if file opens
+            throw std::runtime_error("Failed to open file"); //throws error
+        } //ends if statement
+        struct stat info; //file information
+        if (::fstat(descriptor, &info) != 0) { //runs if size cannot be read
+            ::close(descriptor); //closes file
+            throw std::runtime_error("Failed to open file"); //throws error
+        } //ends if statement
+        length = static_cast<size_t>(info.st_size); //size of file
+        if (length > 0) { //runs if there is anything to map, mmap rejects empty files
+            void* mapping = ::mmap(nullptr, length, copyOnWrite ? PROT_READ | PROT_WRITE : PROT_READ, MAP_PRIVATE, descriptor, 0); //maps file, private so writes never reach the file
+            if (mapping == MAP_FAILED) { //runs if mapping failed
+                ::close(descriptor); //closes file
+                throw std::runtime_error("Failed to map file"); //throws error
+            } //ends if statement
+            ::madvise(mapping, length, MADV_SEQUENTIAL); //tells kernel to read ahead
+            bytes = static_cast<char*>(mapping); //keeps mapping
+        } //ends if statement
+        ::close(descriptor); //mapping stays valid after file is closed
+    } //ends constructor
+
+    ~MappedFile() { //unmaps file
+        if (bytes != nullptr) { //runs if file was mapped
+            ::munmap(bytes, length); //releases mapping
+        } //ends if statement
+    } //ends destructor
+
+    MappedFile(const MappedFile&) = delete; //mappings are owned by one object
+    MappedFile& operator=(const MappedFile&) = delete; //mappings are owned by one object
+
+    const char* begin() const { return bytes; } //first byte of file
+    const char* end() const { return bytes + length; } //one past last byte of file
+    size_t getSize() const { return length; } //size of file in bytes
+    bool isCopyOnWrite() const { return copyOnWrite; } //checks if pages may be written
+    char* writableBegin() const { return copyOnWrite ? bytes : nullptr; } //first byte for copy-on-write writes, null for read-only mappings
+}; //ends MappedFile class definition
+
+struct BinaryMatrixHeader { //64-byte header of a binary matrix file, matrices follow it with every row padded to a cache line
+    char magic[4]; //always "MTXB"
+    uint16_t version; //format version, currently 1
+    uint16_t elementType; //same values as the text typeFlag, 0 for int and 1 for double
+    uint32_t elementSize; //size of one element in bytes
+    uint32_t matrixCount; //number of matrices stored back to back, 2 for inputs and 1 for results
+    uint64_t size; //size of each matrix
+    uint64_t stride; //elements per stored row, row length rounded up to a cache line
+    uint64_t dataOffset; //byte offset of first matrix, a multiple of 64
+    uint64_t matrixBytes; //bytes from one matrix to the next
+    uint32_t flags; //bit 0 set if checksum is filled in
+    uint32_t byteOrder; //0x01020304 as written, files are only read back on machines with the same byte order
+    uint64_t checksum; //checksum of every byte from dataOffset to end of last matrix
+}; //ends BinaryMatrixHeader definition
+static_assert(sizeof(BinaryMatrixHeader) == 64, "binary matrix header must be one cache line"); //keeps the first matrix aligned
+
+constexpr uint16_t binaryMatrixVersion = 1; //format version written by this program
+constexpr uint32_t binaryMatrixHasChecksum = 1; //flag bit for a filled-in checksum
+constexpr uint32_t binaryMatrixByteOrder = 0x01020304; //byte order marker
+
+inline uint64_t binaryMatrixChecksum(const char* bytes, size_t count, uint64_t hash = 0xcbf29ce484222325ULL) { //FNV-1a over 64-bit words, count must be a multiple of 8
+    for (size_t offset = 0; offset < count; offset += 8) { //runs for each word
+        uint64_t word; //next eight bytes
+        std::memcpy(&word, bytes + offset, 8); //reads word without alignment assumptions
+        hash = (hash ^ word) * 0x100000001b3ULL; //mixes word into hash
+    } //ends for loop
+    return hash; //returns hash so far
+} //ends function
+
+template <typename T> //declares template for a generic type T
+uint16_t binaryElementType() { //function maps an element type to its typeFlag
+    static_assert(std::is_same<T, int>::value || std::is_same<T, double>::value, "binary matrix files hold int or double"); //only the text format's types
+    return std::is_same<T, int>::value ? 0 : 1; //0 for int, 1 for double
+} //ends function
+
+inline bool isBinaryMatrixFile(const MappedFile& file) { //function checks for the binary magic number
+    return file.getSize() >= sizeof(BinaryMatrixHeader) && std::memcmp(file.begin(), "MTXB", 4) == 0; //compares first four bytes
+} //ends function
+
+inline BinaryMatrixHeader readBinaryMatrixHeader(const MappedFile& file) { //function reads and validates a binary header
+    BinaryMatrixHeader header; //header being read
+    if (!isBinaryMatrixFile(file)) { //runs if file is not in binary format
+        throw std::runtime_error("Not a binary matrix file"); //throws error
+    } //ends if statement
+    std::memcpy(&header, file.begin(), sizeof(header)); //copies header out of mapping
+    if (header.version != binaryMatrixVersion || header.byteOrder != binaryMatrixByteOrder) { //runs if file came from another version or byte order
+        throw std::runtime_error("Unsupported binary matrix file"); //throws error
+    } //ends if statement
+    const uint64_t elementSize = header.elementType == 0 ? sizeof(int) : sizeof(double); //size implied by type
+    uint64_t rowBytes = 0, matrixBytes = 0, totalBytes = 0; //layout sizes recomputed from the header, checked for overflow so crafted headers fail here rather than in an allocation
+    if (header.elementType > 1 || header.elementSize != elementSize || header.stride < header.size //runs if layout fields disagree
+        || header.dataOffset % 64 != 0 || header.dataOffset < sizeof(BinaryMatrixHeader) || header.dataOffset > file.getSize() //or if data would overlap the header or start past the end
+        || __builtin_mul_overflow(header.stride, elementSize, &rowBytes) || __builtin_mul_overflow(header.size, rowBytes, &matrixBytes) //or if sizes overflow
+        || header.matrixBytes != matrixBytes || __builtin_mul_overflow(uint64_t(header.matrixCount), header.matrixBytes, &totalBytes)
+        || totalBytes > file.getSize() - header.dataOffset) { //or if file is truncated
+        throw std::runtime_error("Corrupt binary matrix file"); //throws error
+    } //ends if statement
+    return header; //returns header
+} //ends function
+
+inline bool verifyBinaryMatrixFile(const MappedFile& file) { //function checks the stored checksum, true if it matches or none was stored
+    const BinaryMatrixHeader header = readBinaryMatrixHeader(file); //validated header
+    if ((header.flags & binaryMatrixHasChecksum) == 0) { //runs if writer skipped checksum
+        return true; //nothing to check
+    } //ends if statement
+    return binaryMatrixChecksum(file.begin() + header.dataOffset, header.matrixCount * header.matrixBytes) == header.checksum; //recomputes and compares
+} //ends function
+
+struct MatrixFileHeader { //first line of a matrix text file
+    size_t size = 0; //size of both matrices
+    int typeFlag = 0; //0 for int matrices, 1 for double matrices
+    size_t bodyOffset = 0; //byte offset where matrix values start
+    bool binary = false; //true if file uses the binary format instead of text
+    bool sparse = false; //true if header ends in "sparse" and values are row col value entries
+}; //ends MatrixFileHeader definition
+
+inline bool isMatrixSpace(char c) { //function checks for the whitespace that separates values, same set as isspace in the C locale
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f'; //compares against whitespace characters
+} //ends function
+
+inline const char* skipMatrixSpace(const char* position, const char* end) { //function skips whitespace
+    while (position < end && isMatrixSpace(*position)) { //runs while on whitespace
+        ++position; //moves forward
+    } //ends while loop
+    return position; //returns first non-whitespace character
+} //ends function
+
+template <typename T> //declares template for a generic type T
+const char* parseMatrixValue(const char* position, const char* end, T& value) { //function parses one value starting at position, returns end of token
+    const char* token = position; //start of token
+    if (token < end && *token == '+') { //runs if value has a leading plus, which from_chars does not accept but >> does
+        ++token; //skips plus sign
+    } //ends if statement
+    std::from_chars_result parsed; //result of parse
+    if constexpr (std::is_floating_point<T>::value) { //runs for floating point types
+        parsed = std::from_chars(token, end, value, std::chars_format::general); //parses fixed or scientific notation
+    } else { //runs for integer types
+        parsed = std::from_chars(token, end, value); //parses decimal integer
+    } //ends if statement
+    if (parsed.ec != std::errc() || (parsed.ptr < end && !isMatrixSpace(*parsed.ptr))) { //runs if token is not one whole value
+        throw std::runtime_error("Invalid value in matrix file"); //throws error
+    } //ends if statement
+    return parsed.ptr; //returns end of token
+} //ends function
+
+inline MatrixFileHeader parseMatrixHeader(const MappedFile& file) { //function reads the size typeFlag header once from a mapped text or binary file
+    MatrixFileHeader header; //header being read
+    if (isBinaryMatrixFile(file)) { //runs if file is in binary format
+        const BinaryMatrixHeader binaryHeader = readBinaryMatrixHeader(file); //validated binary header
+        header.size = binaryHeader.size; //size of matrices
+        header.typeFlag = binaryHeader.elementType; //element type uses typeFlag values
+        header.bodyOffset = binaryHeader.dataOffset; //first matrix
+        header.binary = true; //marks binary format
+        return header; //returns header
+    } //ends if statement
+    const char* position = skipMatrixSpace(file.begin(), file.end()); //start of size
+    position = parseMatrixValue(position, file.end(), header.size); //reads size
+    position = skipMatrixSpace(position, file.end()); //start of typeFlag
+    position = parseMatrixValue(position, file.end(), header.typeFlag); //reads typeFlag
+    const char* marker = position; //possible sparse marker on the same line
+    while (marker < file.end() && (*marker == ' ' || *marker == '\t')) { //runs over spaces, but not onto the next line
+        ++marker; //moves forward
+    } //ends while loop
+    if (file.end() - marker >= 6 && std::memcmp(marker, "sparse", 6) == 0 && (marker + 6 == file.end() || isMatrixSpace(marker[6]))) { //runs if header ends in "sparse"
+        header.sparse = true; //marks sparse format
+        position = marker + 6; //entries start after marker
+    } //ends if statement
+    header.bodyOffset = static_cast<size_t>(position - file.begin()); //values start after header
+    return header; //returns header
+} //ends function
+
+template <typename T> //declares template for a generic type T
+class SparseMatrix { //square matrix in compressed sparse row (CSR) form, memory and work scale with nonzeros
+private: //private members only accessible within SparseMatrix class
+    size_t size; //creates SparseMatrix size variable
+    std::vector<size_t> rowStart; //rowStart[i] to rowStart[i + 1] is the range of row i in colIndex and values
+    std::vector<size_t> colIndex; //column of each stored entry, increasing within a row
+    std::vector<T> values; //value of each stored entry
+
+    size_t find(size_t row, size_t col) const { //function returns position of (row, col) in colIndex, or where it would be inserted
+        return static_cast<size_t>(std::lower_bound(colIndex.begin() + rowStart[row], colIndex.begin() + rowStart[row + 1], col) - colIndex.begin()); //binary search within row
+    } //ends function
+
+    void moveEntry(size_t row, size_t position, size_t newCol) { //function changes the column of one stored entry and keeps the row sorted
+        size_t target = find(row, newCol); //sorted position for new column
+        if (target > position) { //runs if entry moves right
+            --target; //entry itself no longer sits before target
+            std::rotate(colIndex.begin() + position, colIndex.begin() + position + 1, colIndex.begin() + target + 1); //shifts columns left by one
+            std::rotate(values.begin() + position, values.begin() + position + 1, values.begin() + target + 1); //shifts values left by one
+        } else { //runs if entry moves left
+            std::rotate(colIndex.begin() + target, colIndex.begin() + position, colIndex.begin() + position + 1); //shifts columns right by one
+            std::rotate(values.begin() + target, values.begin() + position, values.begin() + position + 1); //shifts values right by one
+        } //ends if statement
+        colIndex[target] = newCol; //stores new column
+    } //ends function
+
+public: //public functions available outside class definition
+    using value_type = T; //element type
+
+    SparseMatrix(size_t n = 0) : size(n), rowStart(n + 1, 0) {} //creates all-zero matrix with no stored entries
+
+    explicit SparseMatrix(const Matrix<T>& dense) : size(dense.getSize()), rowStart(dense.getSize() + 1, 0) { //converts a dense matrix, keeping only nonzero elements
+        ThreadPool& pool = matrixThreadPool(); //threads that share the conversion
+        const size_t grain = std::max<size_t>(1, 16384 / std::max<size_t>(size, 1)); //rows per chunk
+        pool.parallelFor(0, size, grain, [&](size_t first, size_t last) { //counts nonzeros in each row
+            for (size_t i = first; i < last; ++i) { //runs for rows in this range
+                const T* row = dense.rowData(i); //row i of dense matrix
+                rowStart[i + 1] = static_cast<size_t>(std::count_if(row, row + size, [](const T& value) { return value != T(); })); //nonzeros in row
+            } //ends for loop
+        }); //ends parallel loop
+        for (size_t i = 0; i < size; ++i) { //runs for size of matrix
+            rowStart[i + 1] += rowStart[i]; //prefix sum gives start of each row
+        } //ends for loop
+        colIndex.resize(rowStart[size]); //one column per nonzero
+        values.resize(rowStart[size]); //one value per nonzero
+        pool.parallelFor(0, size, grain, [&](size_t first, size_t last) { //copies nonzeros of each row
+            for (size_t i = first; i < last; ++i) { //runs for rows in this range
+                const T* row = dense.rowData(i); //row i of dense matrix
+                size_t position = rowStart[i]; //next slot in row i
+                for (size_t j = 0; j < size; ++j) { //runs for size of matrix
+                    if (row[j] != T()) { //runs if element is nonzero
+                        colIndex[position] = j; //stores column
+                        values[position++] = row[j]; //stores value
+                    } //ends if statement
+                } //ends for loop
+            } //ends for loop
+        }); //ends parallel loop
+    } //ends constructor
+
+    static SparseMatrix<T> fromTriplets(size_t n, std::vector<std::tuple<size_t, size_t, T> > entries) { //builds a matrix from (row, col, value) entries, later duplicates replace earlier ones and zeros are dropped
+        for (const auto& entry : entries) { //runs for each entry
+            if (std::get<0>(entry) >= n || std::get<1>(entry) >= n) { //runs if entry is outside matrix
+                throw std::out_of_range("Index out of range"); //throws error
+            } //ends if statement
+        } //ends for loop
+        std::stable_sort(entries.begin(), entries.end(), [](const std::tuple<size_t, size_t, T>& a, const std::tuple<size_t, size_t, T>& b) { //sorts by row then col, keeping file order for duplicates
+            return std::get<0>(a) != std::get<0>(b) ? std::get<0>(a) < std::get<0>(b) : std::get<1>(a) < std::get<1>(b); //compares positions
+        }); //ends sort
+        SparseMatrix<T> result(n); //empty matrix
+        for (size_t e = 0; e < entries.size(); ++e) { //runs for each entry
+            if (e + 1 < entries.size() && std::get<0>(entries[e]) == std::get<0>(entries[e + 1]) && std::get<1>(entries[e]) == std::get<1>(entries[e + 1])) { //runs if a later entry has the same position
+                continue; //later entry wins
+            } //ends if statement
+            if (std::get<2>(entries[e]) == T()) { //runs if value is zero
+                continue; //zeros are not stored
+            } //ends if statement
+            ++result.rowStart[std::get<0>(entries[e]) + 1]; //counts entry in its row
+            result.colIndex.push_back(std::get<1>(entries[e])); //stores column
+            result.values.push_back(std::get<2>(entries[e])); //stores value
+        } //ends for loop
+        for (size_t i = 0; i < n; ++i) { //runs for size of matrix
+            result.rowStart[i + 1] += result.rowStart[i]; //prefix sum gives start of each row
+        } //ends for loop
+        return result; //returns matrix
+    } //ends function
+
+    Matrix<T> toDense() const { //converts to a dense matrix
+        Matrix<T> dense(size); //zeroed dense matrix
+        for (size_t i = 0; i < size; ++i) { //runs for size of matrix
+            T* row = dense.rowData(i); //row i of dense matrix
+            for (size_t p = rowStart[i]; p < rowStart[i + 1]; ++p) { //runs for stored entries of row i
+                row[colIndex[p]] = values[p]; //copies value
+            } //ends for loop
+        } //ends for loop
+        return dense; //returns dense matrix
+    } //ends function
+
+    size_t getSize() const { return size; } //functions gets size of matrix
+    size_t nonZeros() const { return values.size(); } //number of stored entries
+
+    T at(size_t row, size_t col) const { //checked element read, zero if not stored
+        if (row >= size || col >= size) { //runs if indices are out of range of matrix
+            throw std::out_of_range("Index out of range"); //throws error
+        } //ends if statement
+        const size_t position = find(row, col); //position of entry
+        return position < rowStart[row + 1] && colIndex[position] == col ? values[position] : T(); //stored value or zero
+    } //ends function
+
+    SparseMatrix<T> operator+(const SparseMatrix<T>& other) const { //overloads + operator, merges the sorted rows of both matrices
+        if (size != other.size) { //runs if matrices are different sizes
+            throw std::invalid_argument("Matrix sizes don't match for addition"); //throws error
+        } //ends if statement
+        SparseMatrix<T> result(size); //empty result
+        result.colIndex.reserve(values.size() + other.values.size()); //upper bound on entries
+        result.values.reserve(values.size() + other.values.size()); //upper bound on entries
+        for (size_t i = 0; i < size; ++i) { //runs for size of matrix
+            size_t p = rowStart[i], q = other.rowStart[i]; //positions in row i of each matrix
+            while (p < rowStart[i + 1] || q < other.rowStart[i + 1]) { //runs until both rows are used up
+                const size_t colP = p < rowStart[i + 1] ? colIndex[p] : size; //next column in this matrix
+                const size_t colQ = q < other.rowStart[i + 1] ? other.colIndex[q] : size; //next column in other matrix
+                const size_t col = std::min(colP, colQ); //smaller column goes first
+                T value = T(); //sum at this column
+                if (colP == col) { //runs if this matrix has an entry here
+                    value += values[p++]; //adds it
+                } //ends if statement
+                if (colQ == col) { //runs if other matrix has an entry here
+                    value += other.values[q++]; //adds it
+                } //ends if statement
+                if (value != T()) { //runs unless entries cancelled
+                    result.colIndex.push_back(col); //stores column
+                    result.values.push_back(value); //stores value
+                } //ends if statement
+            } //ends while loop
+            result.rowStart[i + 1] = result.values.size(); //end of row i
+        } //ends for loop
+        return result; //returns result matrix
+    } //ends operator overload
+
+    Matrix<T> operator*(const Matrix<T>& dense) const { //overloads * operator for sparse times dense, work is nonzeros times size
+        if (size != dense.getSize()) { //runs if matrices are different sizes
+            throw std::invalid_argument("Matrix sizes don't match for multiplication"); //throws error
+        } //ends if statement
+        Matrix<T> result(size); //zeroed result
+        matrixThreadPool().parallelFor(0, size, 16, [&](size_t first, size_t last) { //splits rows across threads
+            for (size_t i = first; i < last; ++i) { //runs for rows in this range
+                T* out = result.rowData(i); //row i of result
+                for (size_t p = rowStart[i]; p < rowStart[i + 1]; ++p) { //runs for stored entries of row i
+                    const T scale = values[p]; //entry of this matrix
+                    const T* right = dense.rowData(colIndex[p]); //matching row of dense matrix
+                    for (size_t j = 0; j < size; ++j) { //runs for size of matrix
+                        out[j] += scale * right[j]; //adds scaled row to result row
+                    } //ends for loop
+                } //ends for loop
+            } //ends for loop
+        }); //ends parallel loop
+        return result; //returns result matrix
+    } //ends operator overload
+
+    SparseMatrix<T> operator*(const SparseMatrix<T>& other) const { //overloads * operator for sparse times sparse, row by row (Gustavson) in two passes
+        if (size != other.size) { //runs if matrices are different sizes
+            throw std::invalid_argument("Matrix sizes don't match for multiplication"); //throws error
+        } //ends if statement
+        SparseMatrix<T> result(size); //result, filled below
+        ThreadPool& pool = matrixThreadPool(); //threads that share the rows
+        pool.parallelFor(0, size, 64, [&](size_t first, size_t last) { //first pass counts entries of each result row
+            static thread_local std::vector<size_t> seen; //seen[j] is one more than the last row that touched column j
+            seen.assign(size, 0); //clears marks
+            for (size_t i = first; i < last; ++i) { //runs for rows in this range
+                size_t count = 0; //entries in row i of result
+                for (size_t p = rowStart[i]; p < rowStart[i + 1]; ++p) { //runs for stored entries of row i
+                    const size_t k = colIndex[p]; //row of other matrix to merge
+                    for (size_t q = other.rowStart[k]; q < other.rowStart[k + 1]; ++q) { //runs for stored entries of row k
+                        if (seen[other.colIndex[q]] != i + 1) { //runs if column is new for this row
+                            seen[other.colIndex[q]] = i + 1; //marks column
+                            ++count; //counts entry
+                        } //ends if statement
+                    } //ends for loop
+                } //ends for loop
+                result.rowStart[i + 1] = count; //stores count, turned into a start below
+            } //ends for loop
+        }); //ends parallel loop
+        for (size_t i = 0; i < size; ++i) { //runs for size of matrix
+            result.rowStart[i + 1] += result.rowStart[i]; //prefix sum gives start of each row
+        } //ends for loop
+        result.colIndex.resize(result.rowStart[size]); //one column per possible entry
+        result.values.resize(result.rowStart[size]); //one value per possible entry
+        std::vector<size_t> kept(size); //entries of each row left after dropping zeros from cancellation
+        pool.parallelFor(0, size, 64, [&](size_t first, size_t last) { //second pass fills each result row
+            static thread_local std::vector<T> accumulator; //dense scratch row
+            static thread_local std::vector<size_t> seen; //seen[j] is one more than the last row that touched column j
+            accumulator.assign(size, T()); //clears scratch row
+            seen.assign(size, 0); //clears marks
+            for (size_t i = first; i < last; ++i) { //runs for rows in this range
+                size_t* cols = result.colIndex.data() + result.rowStart[i]; //columns of row i
+                size_t count = 0; //columns collected so far
+                for (size_t p = rowStart[i]; p < rowStart[i + 1]; ++p) { //runs for stored entries of row i
+                    const size_t k = colIndex[p]; //row of other matrix to merge
+                    for (size_t q = other.rowStart[k]; q < other.rowStart[k + 1]; ++q) { //runs for stored entries of row k
+                        const size_t j = other.colIndex[q]; //column of product entry
+                        if (seen[j] != i + 1) { //runs if column is not collected yet
+                            seen[j] = i + 1; //marks column
+                            cols[count++] = j; //collects column
+                        } //ends if statement
+                        accumulator[j] += values[p] * other.values[q]; //accumulates product
+                    } //ends for loop
+                } //ends for loop
+                std::sort(cols, cols + count); //columns in increasing order
+                T* vals = result.values.data() + result.rowStart[i]; //values of row i
+                size_t stored = 0; //entries kept so far, never ahead of c so cols can be compacted in place
+                for (size_t c = 0; c < count; ++c) { //runs for each collected column
+                    const size_t j = cols[c]; //column of entry
+                    if (accumulator[j] != T()) { //runs unless products cancelled to zero, zeros are not stored like in operator+
+                        cols[stored] = j; //keeps column
+                        vals[stored++] = accumulator[j]; //keeps value
+                    } //ends if statement
+                    accumulator[j] = T(); //clears scratch entry
+                } //ends for loop
+                kept[i] = stored; //entries left in row i
+            } //ends for loop
+        }); //ends parallel loop
+        size_t next = 0; //end of compacted entries
+        for (size_t i = 0; i < size; ++i) { //runs for size of matrix, moves each row left over the dropped zeros
+            const size_t start = result.rowStart[i]; //row start before compaction
+            std::copy(result.colIndex.begin() + start, result.colIndex.begin() + start + kept[i], result.colIndex.begin() + next); //moves columns
+            std::copy(result.values.begin() + start, result.values.begin() + start + kept[i], result.values.begin() + next); //moves values
+            result.rowStart[i] = next; //new row start
+            next += kept[i]; //end of row i
+        } //ends for loop
+        result.rowStart[size] = next; //end of last row
+        result.colIndex.resize(next); //drops unused tail
+        result.values.resize(next); //drops unused tail
+        return result; //returns result matrix
+    } //ends operator overload
+
+    void display(std::ostream& out = std::cout) const { //function that displays matrices, zeros included, same layout as Matrix
+        for (size_t i = 0; i < size; ++i) { //runs for number of rows in matrix
+            size_t p = rowStart[i]; //next stored entry of row i
+            for (size_t j = 0; j < size; ++j) { //runs for number of values in each row
+                out << std::setw(8) << (p < rowStart[i + 1] && colIndex[p] == j ? values[p++] : T()); //prints stored value or zero
+            } //ends loop
+            out << '\n'; //starts new line
+        } //ends loop
+    } //ends function
+
+    T sumMainDiagonal() const { //function returns sum of major diagonal
+        T sum = 0; //new variable of type T set to 0
+        for (size_t i = 0; i < size; ++i) { //runs for size of matrix
+            const size_t position = find(i, i); //position of diagonal entry
+            if (position < rowStart[i + 1] && colIndex[position] == i) { //runs if entry is stored
+                sum += values[position]; //adds major diagonal values to sum
+            } //ends if statement
+        } //ends for loop
+        return sum; //returns sum of major diagonal
+    } //ends function
+
+    T sumSecondaryDiagonal() const { //function returns sum of minor diagonal
+        T sum = 0; //new variable of type T set to 0
+        for (size_t i = 0; i < size; ++i) { //runs for size of matrix
+            const size_t position = find(i, size - 1 - i); //position of diagonal entry
+            if (position < rowStart[i + 1] && colIndex[position] == size - 1 - i) { //runs if entry is stored
+                sum += values[position]; //adds minor diagonal values to sum
+            } //ends if statement
+        } //ends for loop
+        return sum; //returns sum of minor diagonal
+    } //ends function
+
+    void swapRows(size_t row1, size_t row2) { //function swaps rows in a matrix, moves only the entries between the two rows
+        if (row1 >= size || row2 >= size) { //checks if rows are within size of matrix
+            throw std::out_of_range("Row index out of range"); //throws error
+        } //ends if statement
+        if (row1 == row2) { //runs if rows are the same
+            return; //nothing to do
+        } //ends if statement
+        const size_t low = std::min(row1, row2), high = std::max(row1, row2); //rows in order
+        const size_t lowLength = rowStart[low + 1] - rowStart[low]; //entries in low row
+        const size_t highLength = rowStart[high + 1] - rowStart[high]; //entries in high row
+        const size_t begin = rowStart[low], middle = rowStart[high], end = rowStart[high + 1]; //range holding both rows and the rows between
+        std::rotate(colIndex.begin() + begin, colIndex.begin() + middle, colIndex.begin() + end); //high row first, then low row, then rows between
+        std::rotate(colIndex.begin() + begin + highLength, colIndex.begin() + begin + highLength + lowLength, colIndex.begin() + end); //rows between back before low row
+        std::rotate(values.begin() + begin, values.begin() + middle, values.begin() + end); //same moves for values
+        std::rotate(values.begin() + begin + highLength, values.begin() + begin + highLength + lowLength, values.begin() + end); //same moves for values
+        for (size_t i = low + 1; i <= high; ++i) { //runs for row starts after low row up to high row
+            rowStart[i] = rowStart[i] + highLength - lowLength; //shifts by change in low row's length
+        } //ends for loop
+    } //ends function
+
+    void swapColumns(size_t col1, size_t col2) { //function swaps cols in a matrix
+        if (col1 >= size || col2 >= size) { //checks if cols are within size of matrix
+            throw std::out_of_range("Column index out of range"); //throws error
+        } //ends if statement
+        if (col1 == col2) { //runs if cols are the same
+            return; //nothing to do
+        } //ends if statement
+        for (size_t i = 0; i < size; ++i) { //runs for size of matrix
+            const size_t position1 = find(i, col1), position2 = find(i, col2); //positions of both columns
+            const bool has1 = position1 < rowStart[i + 1] && colIndex[position1] == col1; //checks if col1 is stored
+            const bool has2 = position2 < rowStart[i + 1] && colIndex[position2] == col2; //checks if col2 is stored
+            if (has1 && has2) { //runs if both are stored
+                std::swap(values[position1], values[position2]); //swaps values in place
+            } else if (has1) { //runs if only col1 is stored
+                moveEntry(i, position1, col2); //moves entry to col2
+            } else if (has2) { //runs if only col2 is stored
+                moveEntry(i, position2, col1); //moves entry to col1
+            } //ends if statement
+        } //ends for loop
+    } //ends function
+
+    void updateElement(size_t row, size_t col, T value) { //function takes two indices and a value, replaces value at indices with value
+        if (row >= size || col >= size) { //checks if given sets of indices is out of bounds of matrix
+            throw std::out_of_range("Index out of range"); //throws error
+        } //ends if statement
+        const size_t position = find(row, col); //position of entry
+        const bool stored = position < rowStart[row + 1] && colIndex[position] == col; //checks if entry is stored
+        if (stored && value != T()) { //runs if entry exists and stays nonzero
+            values[position] = value; //replaces value
+            return; //finished
+        } //ends if statement
+        if (stored) { //runs if entry becomes zero
+            colIndex.erase(colIndex.begin() + position); //removes column
+            values.erase(values.begin() + position); //removes value
+            for (size_t i = row + 1; i <= size; ++i) { //runs for later row starts
+                --rowStart[i]; //one fewer entry before them
+            } //ends for loop
+        } else if (value != T()) { //runs if a new nonzero is added
+            colIndex.insert(colIndex.begin() + position, col); //inserts column
+            values.insert(values.begin() + position, value); //inserts value
+            for (size_t i = row + 1; i <= size; ++i) { //runs for later row starts
+                ++rowStart[i]; //one more entry before them
+            } //ends for loop
+        } //ends if statement
+    } //ends function
+}; //ends SparseMatrix class definition
+
+template <typename T> //declares template for a generic type T
+void loadSparseMatricesFromMapping(const MappedFile& file, const MatrixFileHeader& header, SparseMatrix<T>& matrix1, SparseMatrix<T>& matrix2) { //fills two sparse matrices from a file whose header ends in "sparse"
+    const char* position = file.begin() + header.bodyOffset; //first byte after header
+    const char* end = file.end(); //last byte of file
+    for (SparseMatrix<T>* matrix : {&matrix1, &matrix2}) { //runs for each matrix
+        size_t count; //number of entries
+        position = parseMatrixValue(skipMatrixSpace(position, end), end, count); //reads entry count
+        std::vector<std::tuple<size_t, size_t, T> > entries(count); //entries of this matrix
+        for (auto& entry : entries) { //runs for each entry
+            if (skipMatrixSpace(position, end) == end) { //runs if file ends early
+                throw std::runtime_error("Not enough values in matrix file"); //throws error
+            } //ends if statement
+            position = parseMatrixValue(skipMatrixSpace(position, end), end, std::get<0>(entry)); //reads row
+            position = parseMatrixValue(skipMatrixSpace(position, end), end, std::get<1>(entry)); //reads col
+            position = parseMatrixValue(skipMatrixSpace(position, end), end, std::get<2>(entry)); //reads value
+        } //ends for loop
+        *matrix = SparseMatrix<T>::fromTriplets(header.size, std::move(entries)); //builds CSR matrix
+    } //ends for loop
+} //ends function
+
+template <typename T> //declares template for a generic type T
+void loadMatricesFromMapping(const MappedFile& file, const MatrixFileHeader& header, Matrix<T>& matrix1, Matrix<T>& matrix2) { //fills two matrices from an already mapped and header-parsed file, parsing chunks in parallel
+    if (header.sparse) { //runs if file lists nonzero entries only
+        SparseMatrix<T> sparse1, sparse2; //sparse copies of file contents
+        loadSparseMatricesFromMapping(file, header, sparse1, sparse2); //reads entries
+        matrix1 = sparse1.toDense(); //expands matrix1
+        matrix2 = sparse2.toDense(); //expands matrix2
+        return; //finished
+    } //ends if statement
+    const size_t size = header.size; //size of matrices
+    const size_t perMatrix = size * size; //values in each matrix
+    matrix1 = Matrix<T>(size); //creates new Matrix with type T called matrix1
+    matrix2 = Matrix<T>(size); //creates new Matrix with type T called matrix2
+    const char* begin = file.begin() + header.bodyOffset; //first byte of values
+    const char* end = file.end(); //last byte of file
+
+    ThreadPool& pool = matrixThreadPool(); //threads that share the parsing
+    const size_t bytes = static_cast<size_t>(end - begin); //bytes holding values
+    const size_t chunkCount = bytes < (1 << 20) ? 1 : pool.threadCount() * 4; //small files are parsed by one thread
+    std::vector<const char*> bounds(chunkCount + 1); //chunk boundaries, each on whitespace so no value is split
+    bounds[0] = begin; //first chunk starts at values
+    bounds[chunkCount] = end; //last chunk ends at end of file
+    for (size_t c = 1; c < chunkCount; ++c) { //runs for each inner boundary
+        const char* position = std::max(bounds[c - 1], begin + bytes * c / chunkCount); //evenly spaced guess, never before previous boundary
+        while (position < end && !isMatrixSpace(*position)) { //runs while inside a value
+            ++position; //moves to whitespace after value
+        } //ends while loop
+        bounds[c] = position; //keeps boundary
+    } //ends for loop
+
+    std::vector<size_t> firstIndex(chunkCount + 1, 0); //index of first value in each chunk
+    pool.parallelFor(0, chunkCount, 1, [&](size_t first, size_t last) { //counts values in each chunk
+        for (size_t c = first; c < last; ++c) { //runs for chunks in this range
+            size_t count = 0; //values in chunk
+            const char* position = skipMatrixSpace(bounds[c], bounds[c + 1]); //first value
+            while (position < bounds[c + 1]) { //runs for each value
+                while (position < bounds[c + 1] && !isMatrixSpace(*position)) { //runs while inside value
+                    ++position; //moves past value
+                } //ends while loop
+                ++count; //counts value
+                position = skipMatrixSpace(position, bounds[c + 1]); //moves to next value
+            } //ends while loop
+            firstIndex[c + 1] = count; //stores count, turned into a start index below
+        } //ends for loop
+    }); //ends parallel loop
+    for (size_t c = 0; c < chunkCount; ++c) { //runs for each chunk
+        firstIndex[c + 1] += firstIndex[c]; //prefix sum gives first index of next chunk
+    } //ends for loop
+    if (firstIndex[chunkCount] < 2 * perMatrix) { //runs if file is missing values
+        throw std::runtime_error("Not enough values in matrix file"); //throws error
+    } //ends if statement
+
+    pool.parallelFor(0, chunkCount, 1, [&](size_t first, size_t last) { //parses each chunk straight into the matrix buffers
+        for (size_t c = first; c < last; ++c) { //runs for chunks in this range
+            size_t index = firstIndex[c]; //index of first value in chunk
+            const char* position = skipMatrixSpace(bounds[c], bounds[c + 1]); //first value
+            while (position < bounds[c + 1] && index < 2 * perMatrix) { //runs for each value, extra trailing values are ignored like >> did
+                Matrix<T>& target = index < perMatrix ? matrix1 : matrix2; //first n*n values fill matrix1, next n*n fill matrix2
+                const size_t offset = index % perMatrix; //position inside target
+                position = parseMatrixValue(position, bounds[c + 1], target(offset / size, offset % size)); //parses value into place
+                position = skipMatrixSpace(position, bounds[c + 1]); //moves to next value
+                ++index; //next value
+            } //ends while loop
+        } //ends for loop
+    }); //ends parallel loop
+} //ends function
+
+template <typename T> //declares template for a generic type T
+void writeBinaryMatrixFile(const std::string& filename, const std::vector<const Matrix<T>*>& matrices, bool withChecksum = true) { //function writes matrices in binary format, rows in logical order
+    const size_t size = matrices.empty() ? 0 : matrices[0]->getSize(); //size of every matrix
+    const size_t stride = Matrix<T>::paddedStride(size); //row stride used by Matrix, so files can be wrapped without copying
+    BinaryMatrixHeader header = {}; //header, zero filled
+    std::memcpy(header.magic, "MTXB", 4); //magic number
+    header.version = binaryMatrixVersion; //format version
+    header.elementType = binaryElementType<T>(); //type of elements
+    header.elementSize = sizeof(T); //size of elements
+    header.matrixCount = static_cast<uint32_t>(matrices.size()); //number of matrices
+    header.size = size; //size of matrices
+    header.stride = stride; //padded row length
+    header.dataOffset = sizeof(BinaryMatrixHeader); //matrices start right after header, which is one cache line
+    header.matrixBytes = size * stride * sizeof(T); //bytes per matrix
+    header.flags = withChecksum ? binaryMatrixHasChecksum : 0; //records whether checksum is filled in
+    header.byteOrder = binaryMatrixByteOrder; //byte order marker
+
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc); //opens file for writing
+    if (!file.is_open()) { //checks if file opens
+        throw std::runtime_error("Failed to open file"); //throws error
+    } //ends if statement
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header)); //placeholder header, rewritten once checksum is known
+    std::vector<T> padded(stride, T()); //one row with zeroed padding
+    uint64_t checksum = 0xcbf29ce484222325ULL; //running checksum
+    for (const Matrix<T>* matrix : matrices) { //runs for each matrix
+        if (matrix->getSize() != size) { //runs if matrices are different sizes
+            throw std::invalid_argument("Matrix sizes don't match for binary file"); //throws error
+        } //ends if statement
+        for (size_t i = 0; i < size; ++i) { //runs for size of matrix
+            std::copy(matrix->row(i).begin(), matrix->row(i).end(), padded.begin()); //copies logical row i
+            const char* bytes = reinterpret_cast<const char*>(padded.data()); //row as bytes
+            if (withChecksum) { //runs if checksum is wanted
+                checksum = binaryMatrixChecksum(bytes, stride * sizeof(T), checksum); //mixes row into checksum
+            } //ends if statement
+            file.write(bytes, static_cast<std::streamsize>(stride * sizeof(T))); //writes padded row
+        } //ends for loop
+    } //ends for loop
+    header.checksum = withChecksum ? checksum : 0; //final checksum
+    file.seekp(0); //back to header
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header)); //writes finished header
+    if (!file) { //runs if any write failed
+        throw std::runtime_error("Failed to write file"); //throws error
+    } //ends if statement
+} //ends function
+
+template <typename T> //declares template for a generic type T
+void wrapBinaryMatrices(const std::shared_ptr<const MappedFile>& file, Matrix<T>& matrix1, Matrix<T>& matrix2) { //function points two matrices at a binary file without copying
+    const BinaryMatrixHeader header = readBinaryMatrixHeader(*file); //validated header
+    if (header.elementType != binaryElementType<T>() || header.matrixCount < 2) { //runs if file holds other types or too few matrices
+        throw std::runtime_error("Binary matrix file does not match requested type"); //throws error
+    } //ends if statement
+    if (!file->isCopyOnWrite() || header.stride != Matrix<T>::paddedStride(header.size)) { //runs if mapping cannot be written or rows are laid out differently
+        for (Matrix<T>* matrix : {&matrix1, &matrix2}) { //runs for each matrix
+            const T* source = reinterpret_cast<const T*>(file->begin() + header.dataOffset + (matrix == &matrix1 ? 0 : header.matrixBytes)); //first row in file
+            *matrix = Matrix<T>(header.size); //owned storage
+            for (size_t i = 0; i < header.size; ++i) { //runs for size of matrix
+                std::copy(source + i * header.stride, source + i * header.stride + header.size, matrix->rowData(i)); //copies row
+            } //ends for loop
+        } //ends for loop
+        return; //finished with copies
+    } //ends if statement
+    T* first = reinterpret_cast<T*>(file->writableBegin() + header.dataOffset); //first row of first matrix
+    matrix1 = Matrix<T>::wrapMapping(file, first, header.size, header.stride); //wraps first matrix
+    matrix2 = Matrix<T>::wrapMapping(file, reinterpret_cast<T*>(file->writableBegin() + header.dataOffset + header.matrixBytes), header.size, header.stride); //wraps second matrix
+} //ends function
+
+template <typename T> //declares template for a generic type T
+void loadMatrices(const std::shared_ptr<const MappedFile>& file, const MatrixFileHeader& header, Matrix<T>& matrix1, Matrix<T>& matrix2) { //function fills two matrices from a mapped text or binary file
+    MATRIX_PROFILE_SCOPE(MatrixOp::Load, file->getSize(), 0); //bytes of file read
+    if (header.binary) { //runs if file is in binary format
+        wrapBinaryMatrices(file, matrix1, matrix2); //wraps mapping without copying
+    } else { //runs if file is in text format
+        loadMatricesFromMapping(*file, header, matrix1, matrix2); //parses values
+    } //ends if statement
+} //ends function
+
+template <typename F> //declares template for a callable F taking a type tag
+auto withMatrixType(int typeFlag, F&& body) { //function calls body(int()) or body(double()) for a file's typeFlag, the one place files are mapped to element types
+    if (typeFlag == 0) { //block runs if typeFlag=0, e.g. matrices contain int values
+        return body(int()); //runs body for int matrices
+    } else if (typeFlag == 1) { //runs if typeFlag=1, e.g. matrices contain double values
+        return body(double()); //runs body for double matrices
+    } //ends if statement
+    throw std::invalid_argument("Invalid type flag in input file"); //throws error
+} //ends function
+
+inline void convertTextToBinary(const std::string& textFilename, const std::string& binaryFilename, bool withChecksum = true) { //function converts a matrixfile.txt-style file to binary format
+    const MappedFile file(textFilename); //maps text file
+    const MatrixFileHeader header = parseMatrixHeader(file); //reads size and typeFlag
+    if (header.binary) { //runs if file is already binary
+        throw std::invalid_argument("Input file is already in binary format"); //throws error
+    } //ends if statement
+    withMatrixType(header.typeFlag, [&](auto tag) { //runs once for the file's element type
+        using T = decltype(tag); //element type
+        Matrix<T> matrix1, matrix2; //creates two matrices
+        loadMatricesFromMapping(file, header, matrix1, matrix2); //parses values
+        writeBinaryMatrixFile<T>(binaryFilename, {&matrix1, &matrix2}, withChecksum); //writes binary file
+    }); //ends type dispatch
+} //ends function
+
+class FileDescriptor { //owns an open file descriptor, closed when destroyed
+private: //private members only accessible within FileDescriptor class
+    int descriptor; //open file, or -1
+
+public: //public functions available outside class definition
+    FileDescriptor(const std::string& filename, int flags, mode_t mode = 0644) : descriptor(::open(filename.c_str(), flags, mode)) { //opens file
+        if (descriptor < 0) { //checks if file opens
+            throw std::runtime_error("Failed to open file"); //throws error
+        } //ends if statement
+    } //ends constructor
+
+    ~FileDescriptor() { ::close(descriptor); } //closes file
+
+    FileDescriptor(const FileDescriptor&) = delete; //descriptor is owned by one object
+    FileDescriptor& operator=(const FileDescriptor&) = delete; //descriptor is owned by one object
+
+    void readAt(void* target, size_t count, uint64_t offset) const { //function reads exactly count bytes at offset
+        char* out = static_cast<char*>(target); //next byte to fill
+        while (count > 0) { //runs until every byte is read
+            const ssize_t done = ::pread(descriptor, out, count, static_cast<off_t>(offset)); //reads what it can
+            if (done <= 0) { //runs on error or end of file
+                throw std::runtime_error("Failed to read file"); //throws error
+            } //ends if statement
+            out += done; count -= static_cast<size_t>(done); offset += static_cast<uint64_t>(done); //moves past bytes read
+        } //ends while loop
+    } //ends function
+
+    void writeAt(const void* source, size_t count, uint64_t offset) const { //function writes exactly count bytes at offset
+        const char* in = static_cast<const char*>(source); //next byte to write
+        while (count > 0) { //runs until every byte is written
+            const ssize_t done = ::pwrite(descriptor, in, count, static_cast<off_t>(offset)); //writes what it can
+            if (done <= 0) { //runs on error
+                throw std::runtime_error("Failed to write file"); //throws error
+            } //ends if statement
+            in += done; count -= static_cast<size_t>(done); offset += static_cast<uint64_t>(done); //moves past bytes written
+        } //ends while loop
+    } //ends function
+
+    int get() const { return descriptor; } //function returns raw descriptor
+}; //ends FileDescriptor class definition
+
+template <typename T> //declares template for a generic type T
+struct MatrixTile { //rows x cols block of a matrix held in memory while streaming, rows padded to a cache line
+    size_t stride; //elements between rows
+    std::vector<T, PooledAllocator<T> > data; //elements
+    std::vector<T*> rows; //start of each row
+
+    explicit MatrixTile(size_t tile) : stride(Matrix<T>::paddedStride(tile)), data(tile * stride), rows(tile) { //allocates a tile x tile block
+        for (size_t i = 0; i < tile; ++i) { //runs for rows of tile
+            rows[i] = data.data() + i * stride; //row i
+        } //ends for loop
+    } //ends constructor
+
+    void read(const FileDescriptor& file, uint64_t matrixOffset, size_t fileStride, size_t row0, size_t col0, size_t height, size_t width) { //function fills the top-left height x width corner from a matrix stored at matrixOffset
+        for (size_t i = 0; i < height; ++i) { //runs for rows of block
+            file.readAt(rows[i], width * sizeof(T), matrixOffset + ((row0 + i) * fileStride + col0) * sizeof(T)); //reads one row segment
+        } //ends for loop
+    } //ends function
+
+    void write(const FileDescriptor& file, uint64_t matrixOffset, size_t fileStride, size_t row0, size_t col0, size_t height, size_t width) const { //function writes the top-left height x width corner into a matrix stored at matrixOffset
+        for (size_t i = 0; i < height; ++i) { //runs for rows of block
+            file.writeAt(rows[i], width * sizeof(T), matrixOffset + ((row0 + i) * fileStride + col0) * sizeof(T)); //writes one row segment
+        } //ends for loop
+    } //ends function
+}; //ends MatrixTile definition
+
+inline size_t outOfCoreTileSize(size_t size, size_t elementSize, size_t memoryBudget) { //function picks the tile edge that keeps six tiles within memoryBudget bytes
+    constexpr size_t depth = 256; //GemmBlocking<T>::KC for every T, tiles are whole panels so sums run in the same order as in memory
+    size_t tile = depth; //smallest usable tile
+    while (6 * (tile + depth) * (tile + depth) * elementSize <= memoryBudget && tile < size) { //runs while a larger tile still fits and helps
+        tile += depth; //grows tile by one panel
+    } //ends while loop
+    if (6 * tile * tile * elementSize > memoryBudget && tile < size) { //runs if even one panel does not fit
+        throw std::invalid_argument("Memory budget too small for out-of-core multiply"); //throws error
+    } //ends if statement
+    return std::min(tile, size); //one tile covers small matrices
+} //ends function
+
+template <typename T> //declares template for a generic type T
+void multiplyTilesOutOfCore(const FileDescriptor& in, const BinaryMatrixHeader& input, const FileDescriptor& out, const BinaryMatrixHeader& output, size_t tile) { //function streams C = A * B tile by tile from in to out
+    const size_t size = input.size; //size of matrices
+    const uint64_t offsetA = input.dataOffset; //first matrix in input
+    const uint64_t offsetB = input.dataOffset + input.matrixBytes; //second matrix in input
+    const size_t blocks = (size + tile - 1) / tile; //tiles per row or col
+    const size_t steps = blocks * blocks * blocks; //one step per (I, J, K) tile triple, K fastest
+    MatrixTile<T> a[2] = {MatrixTile<T>(tile), MatrixTile<T>(tile)}; //A tiles, one being used and one being read
+    MatrixTile<T> b[2] = {MatrixTile<T>(tile), MatrixTile<T>(tile)}; //B tiles, one being used and one being read
+    MatrixTile<T> c[2] = {MatrixTile<T>(tile), MatrixTile<T>(tile)}; //C tiles, one being accumulated and one being written
+
+    auto extent = [&](size_t block) { return std::min(tile, size - block * tile); }; //rows or cols in a block
+    auto readStep = [&](size_t step, size_t slot) { //reads the A and B tiles of a step into slot
+        const size_t I = step / (blocks * blocks), J = step / blocks % blocks, K = step % blocks; //tile coordinates
+        a[slot].read(in, offsetA, input.stride, I * tile, K * tile, extent(I), extent(K)); //A(I, K)
+        b[slot].read(in, offsetB, input.stride, K * tile, J * tile, extent(K), extent(J)); //B(K, J)
+    }; //ends lambda
+
+    readStep(0, 0); //first tiles, nothing to overlap with yet
+    std::future<void> reading; //background read of the next step
+    std::future<void> writing; //background write of the last finished C tile
+    size_t current = 0, outputSlot = 0; //slots in use for A/B and for C
+    for (size_t step = 0; step < steps; ++step) { //runs for each tile triple
+        if (step + 1 < steps) { //runs if another step follows
+            reading = std::async(std::launch::async, readStep, step + 1, current ^ 1); //reads next tiles while this one computes
+        } //ends if statement
+        const size_t I = step / (blocks * blocks), J = step / blocks % blocks, K = step % blocks; //tile coordinates
+        if (K == 0) { //runs at the start of a C tile
+            std::fill(c[outputSlot].data.begin(), c[outputSlot].data.end(), T()); //zeros accumulator
+        } //ends if statement
+        const std::vector<const T*> aRows(a[current].rows.begin(), a[current].rows.end()); //rows of A tile
+        const std::vector<const T*> bRows(b[current].rows.begin(), b[current].rows.end()); //rows of B tile
+        gemmAccumulate(extent(I), extent(J), extent(K), aRows.data(), bRows.data(), c[outputSlot].rows.data()); //C(I, J) += A(I, K) * B(K, J), same kernel as in memory
+        if (K + 1 == blocks) { //runs once C(I, J) is complete
+            if (writing.valid()) { //runs if the previous C tile is still being written
+                writing.get(); //waits and passes on write errors
+            } //ends if statement
+            writing = std::async(std::launch::async, [&, I, J, slot = outputSlot] { //writes tile while the next one computes
+                c[slot].write(out, output.dataOffset, output.stride, I * tile, J * tile, extent(I), extent(J)); //streams tile to disk
+            }); //ends lambda
+            outputSlot ^= 1; //next C tile uses the other buffer
+        } //ends if statement
+        if (reading.valid()) { //runs if next tiles are being read
+            reading.get(); //waits and passes on read errors
+        } //ends if statement
+        current ^= 1; //next step uses the tiles just read
+    } //ends for loop
+    if (writing.valid()) { //runs if the last tile is still being written
+        writing.get(); //waits and passes on write errors
+    } //ends if statement
+} //ends function
+
+//Out-of-core product of the two matrices in a binary input file, written as a one-matrix binary file.
+//Working set is six t x t tiles: A and B tiles being multiplied, the next A and B tiles being read by a
+//background task, the C tile being accumulated and the previous C tile being written by another task.
+//t is a multiple of the 256-deep GEMM panel, so every element sums its panels in the same order as the
+//in-memory blocked multiply and the result matches it exactly (Strassen mode is not used here). The budget
+//leaves out the GEMM packing buffers and the kernel page cache, which the kernel reclaims under pressure.
+template <typename T> //declares template for a generic type T
+void multiplyBinaryFileOutOfCore(const std::string& inputFilename, const std::string& outputFilename, size_t memoryBudget, bool withChecksum = true) { //function writes matrix1 * matrix2 from inputFilename to outputFilename using about memoryBudget bytes
+    const BinaryMatrixHeader input = readBinaryMatrixHeader(MappedFile(inputFilename)); //validated header, mapping only touches the first page
+    if (input.elementType != binaryElementType<T>() || input.matrixCount < 2) { //runs if file holds other types or too few matrices
+        throw std::runtime_error("Binary matrix file does not match requested type"); //throws error
+    } //ends if statement
+    const size_t size = input.size; //size of matrices
+    const size_t tile = outOfCoreTileSize(size, sizeof(T), memoryBudget); //tile edge
+    MATRIX_PROFILE_SCOPE(MatrixOp::Multiply, 3 * size * size * sizeof(T), 2 * size * size * size); //counted like an in-memory multiply
+
+    BinaryMatrixHeader output = input; //same type, size and layout
+    output.matrixCount = 1; //one product
+    output.stride = Matrix<T>::paddedStride(size); //Matrix row stride, so the result can be wrapped
+    output.dataOffset = sizeof(BinaryMatrixHeader); //product starts after header
+    output.matrixBytes = size * output.stride * sizeof(T); //bytes of product
+    output.flags = withChecksum ? binaryMatrixHasChecksum : 0; //records whether checksum is filled in
+    output.checksum = 0; //filled in after the product is written
+    const FileDescriptor in(inputFilename, O_RDONLY); //input file
+    const FileDescriptor out(outputFilename, O_RDWR | O_CREAT | O_TRUNC); //output file
+    if (::ftruncate(out.get(), static_cast<off_t>(output.dataOffset + output.matrixBytes)) != 0) { //sizes output, padding reads back as zeros
+        throw std::runtime_error("Failed to write file"); //throws error
+    } //ends if statement
+    out.writeAt(&output, sizeof(output), 0); //header, rewritten once checksum is known
+    if (size <= 16) { //runs for tiny matrices, which operator* multiplies without the blocked kernel
+        Matrix<T> matrix1(size), matrix2(size); //both fit in memory many times over
+        for (size_t i = 0; i < size; ++i) { //runs for size of matrix
+            in.readAt(matrix1.rowData(i), size * sizeof(T), input.dataOffset + i * input.stride * sizeof(T)); //row i of first matrix
+            in.readAt(matrix2.rowData(i), size * sizeof(T), input.dataOffset + input.matrixBytes + i * input.stride * sizeof(T)); //row i of second matrix
+        } //ends for loop
+        const Matrix<T> product = matrix1 * matrix2; //same loop as in memory
+        for (size_t i = 0; i < size; ++i) { //runs for size of matrix
+            out.writeAt(product.rowData(i), size * sizeof(T), output.dataOffset + i * output.stride * sizeof(T)); //row i of product
+        } //ends for loop
+    } else { //runs for matrices the blocked kernel handles
+        multiplyTilesOutOfCore<T>(in, input, out, output, tile); //streams tiles
+    } //ends if statement
+
+    if (withChecksum) { //runs if checksum is wanted
+        std::vector<char> chunk(size_t(1) << 20); //read buffer, a whole number of 8-byte words
+        uint64_t checksum = 0xcbf29ce484222325ULL; //running checksum
+        for (uint64_t done = 0; done < output.matrixBytes; done += chunk.size()) { //runs over the product in order
+            const size_t count = static_cast<size_t>(std::min<uint64_t>(chunk.size(), output.matrixBytes - done)); //bytes in this chunk
+            out.readAt(chunk.data(), count, output.dataOffset + done); //reads chunk back
+            checksum = binaryMatrixChecksum(chunk.data(), count, checksum); //mixes chunk into checksum
+        } //ends for loop
+        output.checksum = checksum; //final checksum
+        out.writeAt(&output, sizeof(output), 0); //finished header
+    } //ends if statement
+} //ends function
+
+inline void multiplyFileOutOfCore(const std::string& inputFilename, const std::string& outputFilename, size_t memoryBudget, bool withChecksum = true) { //function picks the element type from a binary input file and streams its product to outputFilename
+    const BinaryMatrixHeader header = readBinaryMatrixHeader(MappedFile(inputFilename)); //validated header
+    withMatrixType(header.elementType, [&](auto tag) { //runs once for the file's element type
+        multiplyBinaryFileOutOfCore<decltype(tag)>(inputFilename, outputFilename, memoryBudget, withChecksum); //streams product
+    }); //ends type dispatch
+} //ends function
+
+template <typename T> //declares template for a generic type T
+void loadMatricesFromFile(const std::string& filename, Matrix<T>& matrix1, Matrix<T>& matrix2) { //function generates two matrices from a file
+    const std::shared_ptr<const MappedFile> file = std::make_shared<const MappedFile>(filename, true); //maps file, copy-on-write so binary files can be wrapped
+    loadMatrices(file, parseMatrixHeader(*file), matrix1, matrix2); //parses header and values
+} //ends function
+
+template <typename T> //declares template for a generic type T
+void loadMatricesFromFile(const std::string& filename, SparseMatrix<T>& matrix1, SparseMatrix<T>& matrix2) { //function generates two sparse matrices from a sparse, dense text or binary file
+    const std::shared_ptr<const MappedFile> file = std::make_shared<const MappedFile>(filename, true); //maps file
+    const MatrixFileHeader header = parseMatrixHeader(*file); //reads header
+    if (header.sparse) { //runs if file lists nonzero entries only
+        MATRIX_PROFILE_SCOPE(MatrixOp::Load, file->getSize(), 0); //bytes of file read
+        loadSparseMatricesFromMapping(*file, header, matrix1, matrix2); //reads entries straight into CSR form
+        return; //finished
+    } //ends if statement
+    Matrix<T> dense1, dense2; //dense file contents
+    loadMatrices(file, header, dense1, dense2); //reads dense values
+    matrix1 = SparseMatrix<T>(dense1); //keeps nonzeros of matrix1
+    matrix2 = SparseMatrix<T>(dense2); //keeps nonzeros of matrix2
+} //ends function
+
+template <typename T, size_t N> //declares template for element type T and compile-time size N
+void loadMatricesFromFile(const std::string& filename, Matrix<T, N>& matrix1, Matrix<T, N>& matrix2) { //function generates two fixed-size matrices from a file whose size is N
+    Matrix<T> loaded1, loaded2; //runtime-sized file contents
+    loadMatricesFromFile(filename, loaded1, loaded2); //reads any supported format
+    matrix1 = Matrix<T, N>(loaded1); //copies matrix1, throws if file size is not N
+    matrix2 = Matrix<T, N>(loaded2); //copies matrix2
+} //ends function
+
+inline void swapRows(std::vector<std::vector<int> >& matrix, size_t row1, size_t row2) { //int version of func to swap rows in a matrix
+    if (row1 >= matrix.size() || row2 >= matrix.size()) { //checks if rows are within matrix
+        throw std::out_of_range("Row index out of range"); //throws error
+    } //ends if statement
+    std::swap(matrix[row1], matrix[row2]); //swaps rows
+} //ends func
+
+inline void swapRows(std::vector<std::vector<double> >& matrix, size_t row1, size_t row2) { //double version of func to swap rows in a matrix
+    if (row1 >= matrix.size() || row2 >= matrix.size()) { //checks if rows are within matrix
+        throw std::out_of_range("Row index out of range"); //throws error
+    } //ends if statement
+    std::swap(matrix[row1], matrix[row2]); //swaps rows
+} //ends func
+
+template <typename T> //declares template for generic type T
+void updateElement(std::vector<std::vector<T> >& matrix, size_t row, size_t col, T value) { //func that takes two indices and a value of type T
+    if (row >= matrix.size() || col >= matrix[0].size()) { //checks if indices are within matrix
+        throw std::out_of_range("Index out of range"); //throws error
+    } //ends if statement
+    matrix[row][col] = value; //replaces value at row/col with value with type T
+} //ends func
+
+#endif //ends include guard
@@ -1,8 +1,8 @@
 /*
 Name of Program: EECS 348 Lab 9
 Description: Program that reads a file containing two matrices (ints or doubles) and performs various matrix operations
-Input: matrixfile.txt (or any other user-inputted file)
-Output: Matrices and various matrix operations
+Input: matrixfile.txt (or any other user-inputted file), or a batch script given with --batch
+Output: Matrices and various matrix operations, or one JSON object per batch command
 Collaborators: None
 Sources: DeepSeek
 Author: Oscar Ohly
@@ -10,365 +10,402 @@ Creation date: 04/07/2025
 */
 #include <iostream> //gets standard C++ library
 #include <fstream> //gets file reading capabilities
-#include <vector> //gets vector functions used to make matrices
-#include <iomanip> //gets input/output formatting functions
-#include <stdexcept> //gets exception library
-#include <typeinfo> //gets type information
+#include <sstream> //gets string streams for splitting script lines
 #include <limits> //gets numeric limits operations
+#include <memory> //gets smart pointers
+#include <string> //gets string class
+#include <vector> //gets vectors
+#include <cmath> //gets finiteness checks for JSON numbers
+#include "matrix.h" //gets Matrix class and matrix operations
 
-template <typename T> //creates new generic type T
-class Matrix { //new class Matrix
-private: //private functions only accessible within Matrix class
-    size_t size; //creates Matrix size variable
-    std::vector<std::vector<T> > data; //vector of vectors to store matrix data
-
-public: //public functions available outside class definition
-    Matrix(size_t n = 0) : size(n), data(n, std::vector<T>(n)) {} //creates matrix with generic values
-
-    size_t getSize() const { return size; } //functions gets size of matrix
-
-    std::vector<T>& operator[](size_t index) { //defines [] operator allowing for access to rows of matrix
-        if (index >= size) { //runs if index is of out of range of matrix
-            throw std::out_of_range("Index out of range"); //throws error
-        } //ends if statement
-        return data[index]; //returns row of matrix
-    } //ends operator definition
-
-    // Const access operator
-    const std::vector<T>& operator[](size_t index) const { //defines [] operator allowing for access to rows of const Matrix objects
-        if (index >= size) { //runs if index is out of range of matrix
-            throw std::out_of_range("Index out of range"); //throws error
+template <typename T> //declares template for a generic type T
+void runInteractive(const std::shared_ptr<const MappedFile>& file, const MatrixFileHeader& header) { //function runs the interactive menu on the matrices in file
+    const size_t size = header.size; //size of matrices in file
+    Matrix<T> matrix1, matrix2; //creates two matrices matrix1 and matrix2
+    loadMatrices(file, header, matrix1, matrix2); //calls loadMatrices which fills matrix1 and matrix2 with values
+
+    std::cout << "\nMatrix 1:\n"; //prints message
+    matrix1.display(); //prints matrix1
+    std::cout << "\nMatrix 2:\n"; //prints message
+    matrix2.display(); //prints matrix2
+
+    std::cout << "\nMatrix Addition Result:\n"; //prints message
+    Matrix<T> sum = matrix1 + matrix2; //creates matrix sum that uses overloaded + operator to add matrices
+    sum.display(); //prints matrix sum
+
+    std::cout << "\nMatrix Multiplication Result:\n"; //prints message
+    Matrix<T> product = matrix1 * matrix2; //creates matrix product that uses overloaded * operator to multiply matrices
+    product.display(); //prints matrix product
+
+    std::cout << "\nMatrix 1 Diagonal Sums:\n"; //prints message
+    std::cout << "Main Diagonal: " << matrix1.sumMainDiagonal() << "\n"; //calls sumMainDiagonal on matrix1 and prints sum
+    std::cout << "Secondary Diagonal: " << matrix1.sumSecondaryDiagonal() << "\n"; //calls sumMinorDiagonal on matrix1 and prints sum
+
+    int choice; //new int choice
+    do { //do block that runs and could repeat
+        std::cout << (std::is_integral<T>::value ? "\nMenu for operations on Matrix 1:\n" : "\nOperations Menu (Matrix 1):\n"); //prints menu, each type keeps the heading its original branch printed
+        std::cout << "1. Swap Rows\n";
+        std::cout << "2. Swap Columns\n";
+        std::cout << "3. Update Element\n";
+        std::cout << "4. Exit\n";
+        std::cout << "Enter your choice (1-4): ";
+        std::cin >> choice; //sets choice to next user input
+        if (!std::cin) { //runs if input ended or was not a number
+            if (std::cin.eof()) { //runs if there is no more input
+                break; //leaves menu instead of looping forever
+            } //ends if statement
+            std::cin.clear(); //clears user input interface
+            std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); //removes any input from buffer until new line
+            choice = 0; //treated as an invalid choice
         } //ends if statement
-        return data[index]; //returns row of matrix
-    } //ends operator definition
 
-    Matrix<T> operator+(const Matrix<T>& other) const { //overloads + operator allowing for addition of Matrix objects
-        if (size != other.size) { //runs if matrices are different sizes
-            throw std::invalid_argument("Matrix sizes don't match for addition"); //throws error
-        } //ends if statement
-        Matrix<T> result(size); //creates new matrix containing values of type T
-        for (size_t i = 0; i < size; ++i) { //runs for size of matrix
-            for (size_t j = 0; j < size; ++j) { //runs for size of matrix
-                result[i][j] = data[i][j] + other[i][j]; //adds every index of added matrices to result
-            } //ends for loop
-        } //ends for loop
-        return result; //returns result matrix
-    } //ends operator overload
+        try { //block runs if it doesn't error
+            switch (choice) { //switch block with choice used for comparison
+                case 1: { //runs if choice = 1
+                    size_t row1, row2; //creates two size_ts row1 and row2
+                    std::cout << "Enter two row indices to swap (0-based): "; //prints message
+                    std::cin >> row1 >> row2; //sets next two user inputs to row1 and row2
+                    if (!std::cin || row1 >= size || row2 >= size) { //checks if row1 and row2 are within bounds of matrix
+                        std::cin.clear(); //clears user input interface
+                        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); //removes any input from buffer until new line
+                        throw std::out_of_range("Invalid row indices"); //throws error
+                    } //ends if statement
+                    matrix1.swapRows(row1, row2); //swaps rows in matrix1
+                    std::cout << "After swapping rows " << row1 << " and " << row2 << ":\n"; //prints message
+                    matrix1.display(); //displays matrix1 after swap
+                    break; //breaks from switch block
+                } //ends case
+                case 2: { //runs if choice = 2
+                    size_t col1, col2; //creates two size_ts col1 and col2
+                    std::cout << "Enter two column indices to swap (0-based): "; //prints message
+                    std::cin >> col1 >> col2; //sets next two user inputs to col1 and col2
+                    if (!std::cin || col1 >= size || col2 >= size) { //checks if col1 and col2 are within bounds of matrix1
+                        std::cin.clear(); //clears user input interface
+                        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); //removes any input from buffer until new line
+                        throw std::out_of_range("Invalid column indices"); //throws error
+                    } //ends if statement
+                    matrix1.swapColumns(col1, col2); //swaps cols in matrix1
+                    std::cout << "After swapping columns " << col1 << " and " << col2 << ":\n"; //prints message
+                    matrix1.display(); //displays matrix1 after swap
+                    break; //breaks from switch block
+                } //ends case
+                case 3: { //runs if choice = 3
+                    size_t row, col; //creates two size_ts row and col
+                    T value; //creates new value of type T
+                    std::cout << "Enter row, column, and new value (0-based indices): "; //prints message
+                    std::cin >> row >> col >> value; //sets next three user inputs to row, col, and value
+                    if (!std::cin || row >= size || col >= size) { //checks if indices are within bounds
+                        std::cin.clear(); //clears user interface
+                        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); //clears buffer until new line is reached
+                        throw std::out_of_range("Invalid indices"); //throws error
+                    } //ends if statement
+                    matrix1.updateElement(row, col, value); //calls updateElement on matrix1 to update element at row, col to value
+                    std::cout << "After updating element at (" << row << "," << col << "):\n"; //prints message
+                    matrix1.display(); //prints matrix1 after change
+                    break; //breaks from switch block
+                } //ends case
+                case 4: //runs if case = 4
+                    std::cout << "Exiting operations menu.\n"; //prints message
+                    break; //breaks from switch block
+                default: //runs if choice didn't equal any of previous cases
+                    std::cout << "Invalid choice. Please try again.\n"; //prints message
+            } //ends switch block
+        } catch (const std::exception& e) { //runs if error within try block
+            std::cerr << "Error: " << e.what() << ". Please try again.\n"; //prints error message
+        } //ends catch block
+    } while (choice != 4); //repeats do block if choice didn't equal 4
+} //ends function
 
-    Matrix<T> operator*(const Matrix<T>& other) const { //overloads * operator allowing for matrix multiplication
-        if (size != other.size) { //runs if matrices are different sizes
-            throw std::invalid_argument("Matrix sizes don't match for multiplication"); //throws error
+struct BatchCommand { //one line of a batch script
+    size_t line = 0; //line number in script, for error records
+    std::vector<std::string> words; //command name followed by its arguments
+}; //ends BatchCommand definition
+
+void appendJsonString(std::string& out, const std::string& text) { //function appends text as a quoted JSON string
+    out += '"'; //opening quote
+    for (char c : text) { //runs for each character
+        if (c == '"' || c == '\\') { //runs for characters that need a backslash
+            out += '\\'; //escape
+            out += c; //character
+        } else if (static_cast<unsigned char>(c) < 0x20) { //runs for control characters
+            char escaped[8]; //buffer for \u escape
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c)); //formats escape
+            out += escaped; //appends escape
+        } else { //runs for ordinary characters
+            out += c; //appends character
         } //ends if statement
-        Matrix<T> result(size); //new matrix containing values of type T
-        for (size_t i = 0; i < size; ++i) { //runs for size of matrix
-            for (size_t j = 0; j < size; ++j) { //runs for size of matrix
-                for (size_t k = 0; k < size; ++k) { //runs for size of matrix
-                    result[i][j] += data[i][k] * other[k][j]; //performs matrix multiplication and adds final values to result matrix
-                } //ends for loop
-            } //ends for loop
-        } //ends for loop
-        return result; //returns result matrix
-    } //ends operator overloader
-
-    void display() const { //function that displays matrices
-        for (const auto& row : data) { //runs for number of rows in matrix
-            for (const auto& val : row) { //runs for number of values in each row
-                std::cout << std::setw(8) << val; //prints values of matrix with proper spacing
-            } //ends loop
-            std::cout << std::endl; //starts new line
-        } //ends loop
-    } //ends loop
-
-    T sumMainDiagonal() const { //function returns sum of major diagonal
-        T sum = 0; //new variable of type T set to 0
-        for (size_t i = 0; i < size; ++i) { //runs for size of matrix
-            sum += data[i][i]; //adds major diagonal values to sum
-        } //ends for loop
-        return sum; //returns sum of major diagonal
-    } //ends function
-
-    T sumSecondaryDiagonal() const { //function returns sum of minor diagonal
-        T sum = 0; //new variable of type T set to 0
-        for (size_t i = 0; i < size; ++i) { //runs for size of matrix
-            sum += data[i][size - 1 - i]; //adds minor diagonal values to sum
-        } //ends for loop
-        return sum; //returns sum of minor diagonal
-    } //ends function
+    } //ends for loop
+    out += '"'; //closing quote
+} //ends function
 
-    void swapRows(size_t row1, size_t row2) { //function swaps rows in a matrix
-        if (row1 >= size || row2 >= size) { //checks if rows are within size of matrix
-            throw std::out_of_range("Row index out of range"); //throws error
+template <typename T> //declares template for a generic type T
+void appendJsonNumber(std::string& out, T value) { //function appends a number in shortest round-trip form, NaN and infinity become null
+    if constexpr (std::is_floating_point<T>::value) { //runs for floating point types
+        if (!std::isfinite(value)) { //runs if JSON cannot represent value
+            out += "null"; //JSON null
+            return; //finished
         } //ends if statement
-        std::swap(data[row1], data[row2]); //swaps rows using overloaded [] operator
-    } //ends function
+    } //ends if statement
+    char buffer[32]; //large enough for any int or double
+    const std::to_chars_result written = std::to_chars(buffer, buffer + sizeof(buffer), value); //formats value without locale
+    out.append(buffer, written.ptr); //appends digits
+} //ends function
 
-    void swapColumns(size_t col1, size_t col2) { //function swaps cols in a matrix
-        if (col1 >= size || col2 >= size) { //checks if cols are within size of matrix
-            throw std::out_of_range("Column index out of range"); //throws error
-        } //ends if statement
-        for (size_t i = 0; i < size; ++i) { //runs for size of matrix
-            std::swap(data[i][col1], data[i][col2]); //swaps cols using overloaded [] operator, index by index
+template <typename T> //declares template for a generic type T
+void appendJsonMatrix(std::string& out, const Matrix<T>& matrix) { //function appends a matrix as an array of row arrays
+    out += '['; //opens matrix
+    for (size_t i = 0; i < matrix.getSize(); ++i) { //runs for each row
+        out += i == 0 ? "[" : ",["; //opens row
+        const T* row = matrix.rowData(i); //row i
+        for (size_t j = 0; j < matrix.getSize(); ++j) { //runs for each element
+            if (j > 0) { //runs for every element after the first
+                out += ','; //separator
+            } //ends if statement
+            appendJsonNumber(out, row[j]); //element
         } //ends for loop
-    } //ends function
-
-    void updateElement(size_t row, size_t col, T value) { //function takes two indices and a value, replaces value at indices with value
-        if (row >= size || col >= size) { //checks if given sets of indices is out of bounds of matrix
-            throw std::out_of_range("Index out of range"); //throws error
-        } //ends if statement
-        data[row][col] = value; //replaces value at row/col with value
-    } //ends function
-}; //ends Matrix class definition
+        out += ']'; //closes row
+    } //ends for loop
+    out += ']'; //closes matrix
+} //ends function
 
-template <typename T> //declares template for a generic type T
-void loadMatricesFromFile(const std::string& filename, Matrix<T>& matrix1, Matrix<T>& matrix2) { //function generates two matrices from a file
-    std::ifstream file(filename); //opens file with name filename
-    if (!file.is_open()) { //checks if file opens
-        throw std::runtime_error("Failed to open file"); //throws error
+size_t parseBatchIndex(const BatchCommand& command, size_t position) { //function reads an index argument of a command
+    if (position >= command.words.size()) { //runs if argument is missing
+        throw std::invalid_argument("Missing argument for " + command.words[0]); //throws error
     } //ends if statement
+    const std::string& word = command.words[position]; //argument text
+    size_t index; //parsed index
+    parseMatrixValue(word.data(), word.data() + word.size(), index); //parses whole word or throws
+    return index; //returns index
+} //ends function
 
-    size_t size; //creates size_T size
-    int typeFlag; //creates int typeFlag representing type of matrices
-    file >> size >> typeFlag; //sets first value in file to size, second value to typeFlag
-
-    matrix1 = Matrix<T>(size); //creates new Matrix with type T called matrix1
-    matrix2 = Matrix<T>(size); //creates new Matrix with type T called matrix2
-
-    for (size_t i = 0; i < size; ++i) { //runs for size of matrix1
-        for (size_t j = 0; j < size; ++j) { //runs for size of matrix1
-            file >> matrix1[i][j]; //fills matrix1 with values from file
-        } //ends loop
-    } //ends loop
+void beginBatchRecord(std::string& out, size_t job, const BatchCommand& command) { //function starts the JSON object for one command
+    out += "{\"job\":"; //job number key
+    appendJsonNumber(out, job); //job number
+    out += ",\"line\":"; //line number key
+    appendJsonNumber(out, command.line); //line number
+    out += ",\"op\":"; //operation key
+    appendJsonString(out, command.words[0]); //operation name
+} //ends function
 
-    for (size_t i = 0; i < size; ++i) { //runs for size of matrix2
-        for (size_t j = 0; j < size; ++j) { //runs for size of matrix2
-            file >> matrix2[i][j]; //fills matrix2 with values from file
-        } //ends loop
-    } //ends loop
+void beginLoadRecord(std::string& out, size_t job, size_t line, const std::string& filename) { //function starts the JSON object for a load, line 0 for the input file on the command line
+    out += "{\"job\":"; //job number key
+    appendJsonNumber(out, job); //job number
+    out += ",\"line\":"; //line number key
+    appendJsonNumber(out, line); //line number
+    out += ",\"op\":\"load\",\"file\":"; //operation and file keys
+    appendJsonString(out, filename); //file name
 } //ends function
 
-void swapRows(std::vector<std::vector<int> >& matrix, size_t row1, size_t row2) { //int version of func to swap rows in a matrix
-    if (row1 >= matrix.size() || row2 >= matrix.size()) { //checks if rows are within matrix
-        throw std::out_of_range("Row index out of range"); //throws error
+void flushBatchOutput(std::string& out, bool force) { //function writes buffered output in large blocks
+    if (force || out.size() >= (1 << 20)) { //runs if buffer is full or caller is finishing
+        std::cout.write(out.data(), static_cast<std::streamsize>(out.size())); //writes buffer
+        out.clear(); //empties buffer, keeping its capacity
     } //ends if statement
-    std::swap(matrix[row1], matrix[row2]); //swaps rows
-} //ends func
-
-void swapRows(std::vector<std::vector<double> >& matrix, size_t row1, size_t row2) { //double version of func to swap rows in a matrix
-    if (row1 >= matrix.size() || row2 >= matrix.size()) { //checks if rows are within matrix
-        throw std::out_of_range("Row index out of range"); //throws error
+    if (force) { //runs if caller is finishing
+        std::cout.flush(); //one flush at the end
     } //ends if statement
-    std::swap(matrix[row1], matrix[row2]); //swaps rows
-} //ends func
+} //ends function
 
-template <typename T> //declares template for generic type T
-void updateElement(std::vector<std::vector<T> >& matrix, size_t row, size_t col, T value) { //func that takes two indices and a value of type T
-    if (row >= matrix.size() || col >= matrix[0].size()) { //checks if indices are within matrix
-        throw std::out_of_range("Index out of range"); //throws error
+template <typename T> //declares template for a generic type T
+bool runBatchJob(size_t job, size_t loadLine, const std::string& filename, const std::shared_ptr<const MappedFile>& file, const MatrixFileHeader& header, const std::vector<BatchCommand>& commands, size_t first, size_t last, std::string& out) { //function loads one file and runs commands [first, last) on it, returns false if any failed
+    Matrix<T> loaded1, matrix2, result; //input matrices and a result matrix whose storage is reused by every command
+    loadMatrices(file, header, loaded1, matrix2); //fills matrix1 and matrix2 with values
+    TrackedMatrix<T> matrix1(std::move(loaded1)); //matrix1 keeps its sums and product with matrix2 up to date across edits
+    matrix1.setRightOperand(matrix2); //product is formed on first multiply, then patched
+    beginLoadRecord(out, job, loadLine, filename); //load succeeded, so it gets its own record like every other command
+    out += ",\"size\":"; //size key
+    appendJsonNumber(out, header.size); //matrix size
+    out += ",\"type\":"; //element type key
+    appendJsonString(out, std::is_integral<T>::value ? "int" : "double"); //element type
+    out += "}\n"; //closes record
+    bool succeeded = true; //becomes false on the first failed command
+    for (size_t c = first; c < last; ++c) { //runs for each command of this job
+        const BatchCommand& command = commands[c]; //command being run
+        const std::string& op = command.words[0]; //command name
+        const size_t mark = out.size(); //start of this record, so a failed command can be rewritten as an error
+        try { //block runs if it doesn't error
+            beginBatchRecord(out, job, command); //starts record
+            if (op == "add") { //runs for addition
+                result = matrix1.get() + matrix2; //fused addition into reused storage
+                out += ",\"result\":"; //result key
+                appendJsonMatrix(out, result); //sum
+            } else if (op == "multiply") { //runs for multiplication
+                out += ",\"result\":"; //result key
+                appendJsonMatrix(out, matrix1.product()); //cached product, patched for edits since the last multiply
+            } else if (op == "diagonals") { //runs for diagonal sums of matrix1
+                out += ",\"main\":"; //main diagonal key
+                appendJsonNumber(out, matrix1.sumMainDiagonal()); //main diagonal sum
+                out += ",\"secondary\":"; //secondary diagonal key
+                appendJsonNumber(out, matrix1.sumSecondaryDiagonal()); //secondary diagonal sum
+            } else if (op == "rowsum" || op == "colsum") { //runs for one row or column sum of matrix1
+                const size_t index = parseBatchIndex(command, 1); //row or column index
+                out += ",\"index\":"; //index key
+                appendJsonNumber(out, index); //index
+                out += ",\"sum\":"; //sum key
+                appendJsonNumber(out, op == "rowsum" ? matrix1.rowSum(index) : matrix1.columnSum(index)); //kept up to date by every edit
+            } else if (op == "swaprows" || op == "swapcols") { //runs for row or column swaps on matrix1
+                const size_t index1 = parseBatchIndex(command, 1); //first index
+                const size_t index2 = parseBatchIndex(command, 2); //second index
+                if (op == "swaprows") { //runs for row swap
+                    matrix1.swapRows(index1, index2); //swaps rows in matrix1
+                } else { //runs for column swap
+                    matrix1.swapColumns(index1, index2); //swaps cols in matrix1
+                } //ends if statement
+                out += ",\"indices\":["; //indices key
+                appendJsonNumber(out, index1); //first index
+                out += ','; //separator
+                appendJsonNumber(out, index2); //second index
+                out += ']'; //closes indices
+            } else if (op == "update") { //runs for element update on matrix1
+                const size_t row = parseBatchIndex(command, 1); //row index
+                const size_t col = parseBatchIndex(command, 2); //column index
+                if (command.words.size() < 4) { //runs if value is missing
+                    throw std::invalid_argument("Missing argument for update"); //throws error
+                } //ends if statement
+                T value; //new value
+                parseMatrixValue(command.words[3].data(), command.words[3].data() + command.words[3].size(), value); //parses value like the file loader does
+                matrix1.updateElement(row, col, value); //updates element
+                out += ",\"row\":"; //row key
+                appendJsonNumber(out, row); //row index
+                out += ",\"col\":"; //column key
+                appendJsonNumber(out, col); //column index
+                out += ",\"value\":"; //value key
+                appendJsonNumber(out, value); //new value
+            } else if (op == "print") { //runs for printing a matrix
+                const size_t which = command.words.size() > 1 ? parseBatchIndex(command, 1) : 1; //matrix number, matrix1 by default
+                if (which != 1 && which != 2) { //runs if matrix number is not 1 or 2
+                    throw std::out_of_range("Matrix number must be 1 or 2"); //throws error
+                } //ends if statement
+                out += ",\"matrix\":"; //matrix key
+                appendJsonNumber(out, which); //matrix number
+                out += ",\"result\":"; //result key
+                appendJsonMatrix(out, which == 1 ? matrix1.get() : matrix2); //matrix
+            } else { //runs for unknown commands
+                throw std::invalid_argument("Unknown command " + op); //throws error
+            } //ends if statement
+            out += "}\n"; //closes record
+        } catch (const std::exception& e) { //runs if command failed
+            out.resize(mark); //drops partial record
+            beginBatchRecord(out, job, command); //starts error record
+            out += ",\"error\":"; //error key
+            appendJsonString(out, e.what()); //error message
+            out += "}\n"; //closes record
+            succeeded = false; //remembers failure
+        } //ends catch block
+        flushBatchOutput(out, false); //writes buffer if it is large
+    } //ends for loop
+    return succeeded; //returns whether every command worked
+} //ends function
+
+int runBatch(const std::string& scriptName, const std::string& inputName) { //function runs a batch script with no prompts, returns exit code
+    std::ios::sync_with_stdio(false); //output is written in large blocks, so C stdio sync is not needed
+    std::ifstream scriptFile; //script file, unused when reading stdin
+    if (scriptName != "-") { //runs if script is a file
+        scriptFile.open(scriptName); //opens script
+        if (!scriptFile.is_open()) { //checks if file opens
+            throw std::runtime_error("Failed to open file"); //throws error
+        } //ends if statement
     } //ends if statement
-    matrix[row][col] = value; //replaces value at row/col with value with type T
-} //ends func
+    std::istream& script = scriptName == "-" ? std::cin : scriptFile; //script source
+    std::vector<BatchCommand> commands; //every command in script
+    std::string text; //one script line
+    for (size_t line = 1; std::getline(script, text); ++line) { //runs for each line
+        BatchCommand command; //command on this line
+        command.line = line; //line number
+        std::istringstream words(text.substr(0, text.find('#'))); //line without comment
+        for (std::string word; words >> word;) { //runs for each word
+            command.words.push_back(word); //keeps word
+        } //ends for loop
+        if (!command.words.empty()) { //runs unless line was blank
+            commands.push_back(command); //keeps command
+        } //ends if statement
+    } //ends for loop
+
+    std::string out; //buffered JSON lines
+    bool succeeded = true; //becomes false if any command fails
+    size_t job = 0; //number of current job
+    std::string filename = inputName; //file for commands before the first load
+    size_t loadLine = 0; //script line of the load that named filename, 0 for the command line
+    size_t first = 0; //first command of current job
+    while (first <= commands.size()) { //runs for each job, a job is the commands between two loads
+        size_t last = first; //end of job
+        while (last < commands.size() && commands[last].words[0] != "load") { //runs until next load
+            ++last; //includes command in job
+        } //ends while loop
+        if (loadLine > 0 || !filename.empty() || first < last) { //runs unless there is nothing to do before the first load
+            ++job; //new job number
+            try { //block runs if it doesn't error
+                if (filename.empty()) { //runs if load had no file name or commands came before any load
+                    throw std::runtime_error(loadLine > 0 ? "Missing argument for load" : "No input file loaded"); //throws error
+                } //ends if statement
+                const std::shared_ptr<const MappedFile> file = std::make_shared<const MappedFile>(filename, true); //maps file once for header and values
+                const MatrixFileHeader header = parseMatrixHeader(*file); //reads size and typeFlag
+                succeeded = withMatrixType(header.typeFlag, [&](auto tag) { //picks element type once per job
+                    return runBatchJob<decltype(tag)>(job, loadLine, filename, file, header, commands, first, last, out); //loads file and runs job's commands
+                }) && succeeded; //keeps earlier failures
+            } catch (const std::exception& e) { //runs if file could not be loaded
+                beginLoadRecord(out, job, loadLine, filename); //starts error record
+                out += ",\"error\":"; //error key
+                appendJsonString(out, e.what()); //error message
+                out += "}\n"; //closes record
+                for (size_t c = first; c < last; ++c) { //runs for each command of the job, so every script line still gets a record
+                    beginBatchRecord(out, job, commands[c]); //starts error record
+                    out += ",\"error\":\"Input file not loaded\"}\n"; //error record
+                } //ends for loop
+                succeeded = false; //remembers failure
+            } //ends catch block
+        } //ends if statement
+        if (last == commands.size()) { //runs if script is finished
+            break; //no more jobs
+        } //ends if statement
+        if (commands[last].words.size() < 2) { //runs if load has no file name
+            filename.clear(); //following commands fail until a valid load
+        } else { //runs if load names a file
+            filename = commands[last].words[1]; //file for next job
+        } //ends if statement
+        loadLine = commands[last].line; //line of load, reported in its record
+        first = last + 1; //next job starts after load
+    } //ends while loop
+    flushBatchOutput(out, true); //writes remaining output
+    return succeeded ? 0 : 2; //exit code 2 if any command failed
+} //ends function
 
-int main() { //func main that runs when program is executed
+int main(int argc, char* argv[]) { //func main that runs when program is executed
     try { //try block that runs if code doesn't error
+        if (argc > 1) { //runs if command-line options were given
+            const std::string option(argv[1]); //first option
+            if (option == "--convert" && argc == 4) { //runs if a text to binary conversion was requested
+                convertTextToBinary(argv[2], argv[3]); //writes binary file
+                std::cout << "Wrote " << argv[3] << "\n"; //prints message
+                return 0; //conversion finished
+            } //ends if statement
+            if (option == "--verify" && argc == 3) { //runs if a binary checksum check was requested
+                const bool valid = verifyBinaryMatrixFile(MappedFile(argv[2])); //recomputes checksum
+                std::cout << (valid ? "Checksum OK\n" : "Checksum mismatch\n"); //prints result
+                return valid ? 0 : 1; //nonzero exit if file is damaged
+            } //ends if statement
+            if (option == "--multiply-ooc" && (argc == 4 || argc == 5)) { //runs if an out-of-core product was requested
+                const size_t budget = (argc == 5 ? std::stoull(argv[4]) : 1024) << 20; //memory budget in MiB, 1 GiB by default
+                multiplyFileOutOfCore(argv[2], argv[3], budget); //streams product to disk
+                std::cout << "Wrote " << argv[3] << "\n"; //prints message
+                return 0; //multiply finished
+            } //ends if statement
+            if (option == "--batch" && (argc == 3 || argc == 4)) { //runs if a batch script was given
+                return runBatch(argv[2], argc == 4 ? argv[3] : ""); //runs script with no prompts
+            } //ends if statement
+            std::cerr << "Usage: " << argv[0] << " [--batch <script|-> [input file] | --convert <text file> <binary file> | --verify <binary file> | --multiply-ooc <binary file> <output file> [memory MiB]]\n"; //prints usage
+            return 1; //unknown options
+        } //ends if statement
+
         std::string filename; //initializes variable filename that stores name of file
         std::cout << "Enter the input file name: "; //prints message
         std::cin >> filename; //sets filename to next user input
 
-        int typeFlag; //new int typeFlag
-        size_t size; //new size_T size
-        
-        std::ifstream tempFile(filename); //opens file
-        if (!tempFile.is_open()) { //checks if file is open
-            throw std::runtime_error("Failed to open file"); //throws error
-        } //ends if statement
-        tempFile >> size >> typeFlag; //sets first value in tempFile to size, second value to typeFlag
-        tempFile.close(); //closes file
-
-        if (typeFlag == 0) { //block runs if typeFlag=0, e.g. matrices contain int values
-            Matrix<int> matrix1, matrix2; //creates two int matrices matrix1 and matrix2
-            loadMatricesFromFile(filename, matrix1, matrix2); //calls loadMatricesFromFile which fills matrix1 and matrix2 with values
-
-            std::cout << "\nMatrix 1:\n"; //prints message
-            matrix1.display(); //prints matrix1
-            std::cout << "\nMatrix 2:\n"; //prints message
-            matrix2.display(); //prints matrix2
-
-            std::cout << "\nMatrix Addition Result:\n"; //prints message
-            Matrix<int> sum = matrix1 + matrix2; //creates matrix sum that uses overloaded + operator to add matrices
-            sum.display(); //prints matrix sum
-
-            std::cout << "\nMatrix Multiplication Result:\n"; //prints message
-            Matrix<int> product = matrix1 * matrix2; //creates matrix product that uses overloaded * operator to multiply matrices
-            product.display(); //prints matrix product
-
-            std::cout << "\nMatrix 1 Diagonal Sums:\n"; //prints message
-            std::cout << "Main Diagonal: " << matrix1.sumMainDiagonal() << "\n"; //calls sumMainDiagonal on matrix1 and prints sum
-            std::cout << "Secondary Diagonal: " << matrix1.sumSecondaryDiagonal() << "\n"; //calls sumMinorDiagonal on matrix1 and prints sum
-
-            int choice; //new int choice
-            do { //do block that runs and could repeat
-                std::cout << "\nMenu for operations on Matrix 1:\n"; //(lines 210-215) prints menu
-                std::cout << "1. Swap Rows\n";
-                std::cout << "2. Swap Columns\n";
-                std::cout << "3. Update Element\n";
-                std::cout << "4. Exit\n";
-                std::cout << "Enter your choice (1-4): ";
-                std::cin >> choice; //sets choice to next user input
-
-                try { //block runs if it doesn't error
-                    switch (choice) { //switch block with choice used for comparison
-                        case 1: { //runs if choice = 1
-                            size_t row1, row2; //creates two size_ts row1 and row2
-                            std::cout << "Enter two row indices to swap (0-based): "; //prints message
-                            std::cin >> row1 >> row2; //sets next two user inputs to row1 and row2
-                            if (!std::cin || row1 >= size || row2 >= size) { //checks if row1 and row2 are within bounds of matrix
-                                std::cin.clear(); //clears user input interface
-                                std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); //removes any input from buffer until new line
-                                throw std::out_of_range("Invalid row indices"); //throws error
-                            } //ends if statement
-                            matrix1.swapRows(row1, row2); //swaps rows in matrix1
-                            std::cout << "After swapping rows " << row1 << " and " << row2 << ":\n"; //prints message
-                            matrix1.display(); //displays matrix1 after swap
-                            break; //breaks from switch block
-                        } //ends case
-                        case 2: { //runs if choice = 2
-                            size_t col1, col2; //creates two size_ts col1 and col2
-                            std::cout << "Enter two column indices to swap (0-based): "; //prints message
-                            std::cin >> col1 >> col2; //sets next two user inputs to col1 and col2
-                            if (!std::cin || col1 >= size || col2 >= size) { //checks if col1 and col2 are within bounds of matrix1
-                                std::cin.clear(); //clears user input interface
-                                std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); //removes any input from buffer until new line
-                                throw std::out_of_range("Invalid column indices"); //throws error
-                            } //ends if statement
-                            matrix1.swapColumns(col1, col2); //swaps cols in matrix1
-                            std::cout << "After swapping columns " << col1 << " and " << col2 << ":\n"; //prints message
-                            matrix1.display(); //displays matrix1 after swap
-                            break; //breaks from switch block
-                        } //ends case
-                        case 3: { //runs if choice = 3
-                            size_t row, col; //creates two size_ts row and col
-                            int value; //creates new int value
-                            std::cout << "Enter row, column, and new value (0-based indices): "; //prints message
-                            std::cin >> row >> col >> value; //sets next three user inputs to row, col, and value
-                            if (!std::cin || row >= size || col >= size) { //checks if indices are within bounds
-                                std::cin.clear(); //clears user interface
-                                std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); //clears buffer until new line is reached
-                                throw std::out_of_range("Invalid indices"); //throws error
-                            } //ends if statement
-                            matrix1.updateElement(row, col, value); //calls updateElement on matrix1 to update element at row, col to value
-                            std::cout << "After updating element at (" << row << "," << col << "):\n"; //prints message
-                            matrix1.display(); //prints matrix1 after change
-                            break; //breaks from switch block
-                        } //ends case
-                        case 4: //runs if case = 4
-                            std::cout << "Exiting operations menu.\n"; //prints message
-                            break; //breaks from switch block
-                        default: //runs if choice didn't equal any of previous cases
-                            std::cout << "Invalid choice. Please try again.\n"; //prints message
-                    } //ends switch block
-                } catch (const std::exception& e) { //runs if error within try block
-                    std::cerr << "Error: " << e.what() << ". Please try again.\n"; //prints error message
-                } //ends catch block
-            } while (choice != 4); //repeats do block if choice didn't equal 4
-
-        } else if (typeFlag == 1) { //runs if typeFlag=1, e.g. matrices contain double values
-        //(lines 275-368) All the same code as code in above if statement, only handles double values instead of ints
-            Matrix<double> matrix1, matrix2;
-            loadMatricesFromFile(filename, matrix1, matrix2);
-
-            std::cout << "\nMatrix 1:\n";
-            matrix1.display();
-            std::cout << "\nMatrix 2:\n";
-            matrix2.display();
-
-            // Matrix addition
-            std::cout << "\nMatrix Addition Result:\n";
-            Matrix<double> sum = matrix1 + matrix2;
-            sum.display();
-
-            // Matrix multiplication
-            std::cout << "\nMatrix Multiplication Result:\n";
-            Matrix<double> product = matrix1 * matrix2;
-            product.display();
-
-            // Diagonal sums
-            std::cout << "\nMatrix 1 Diagonal Sums:\n";
-            std::cout << "Main Diagonal: " << matrix1.sumMainDiagonal() << "\n";
-            std::cout << "Secondary Diagonal: " << matrix1.sumSecondaryDiagonal() << "\n";
-
-            // User input for operations on Matrix 1
-            int choice;
-            do {
-                std::cout << "\nOperations Menu (Matrix 1):\n";
-                std::cout << "1. Swap Rows\n";
-                std::cout << "2. Swap Columns\n";
-                std::cout << "3. Update Element\n";
-                std::cout << "4. Exit\n";
-                std::cout << "Enter your choice (1-4): ";
-                std::cin >> choice;
-
-                try {
-                    switch (choice) {
-                        case 1: {
-                            // Swap rows
-                            size_t row1, row2;
-                            std::cout << "Enter two row indices to swap (0-based): ";
-                            std::cin >> row1 >> row2;
-                            if (!std::cin || row1 >= size || row2 >= size) {
-                                std::cin.clear();
-                                std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-                                throw std::out_of_range("Invalid row indices");
-                            }
-                            matrix1.swapRows(row1, row2);
-                            std::cout << "After swapping rows " << row1 << " and " << row2 << ":\n";
-                            matrix1.display();
-                            break;
-                        }
-                        case 2: {
-                            // Swap columns
-                            size_t col1, col2;
-                            std::cout << "Enter two column indices to swap (0-based): ";
-                            std::cin >> col1 >> col2;
-                            if (!std::cin || col1 >= size || col2 >= size) {
-                                std::cin.clear();
-                                std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-                                throw std::out_of_range("Invalid column indices");
-                            }
-                            matrix1.swapColumns(col1, col2);
-                            std::cout << "After swapping columns " << col1 << " and " << col2 << ":\n";
-                            matrix1.display();
-                            break;
-                        }
-                        case 3: {
-                            // Update element
-                            size_t row, col;
-                            double value;
-                            std::cout << "Enter row, column, and new value (0-based indices): ";
-                            std::cin >> row >> col >> value;
-                            if (!std::cin || row >= size || col >= size) {
-                                std::cin.clear();
-                                std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-                                throw std::out_of_range("Invalid indices");
-                            }
-                            matrix1.updateElement(row, col, value);
-                            std::cout << "After updating element at (" << row << "," << col << "):\n";
-                            matrix1.display();
-                            break;
-                        }
-                        case 4:
-                            std::cout << "Exiting operations menu.\n";
-                            break;
-                        default:
-                            std::cout << "Invalid choice. Please try again.\n";
-                    }
-                } catch (const std::exception& e) {
-                    std::cerr << "Error: " << e.what() << ". Please try again.\n";
-                }
-            } while (choice != 4);
-
-        } else { //runs if typeFlag didn't equal 1 or 0
-            throw std::invalid_argument("Invalid type flag in input file"); //throws error
-        } //ends if statement
+        const std::shared_ptr<const MappedFile> file = std::make_shared<const MappedFile>(filename, true); //maps file once for both the header and the values, copy-on-write so binary files are used in place
+        const MatrixFileHeader header = parseMatrixHeader(*file); //reads size and typeFlag from text or binary header
+        withMatrixType(header.typeFlag, [&](auto tag) { //picks int or double matrices from typeFlag
+            runInteractive<decltype(tag)>(file, header); //runs menu on matrices of that type
+        }); //ends type dispatch
 
     } catch (const std::exception& e) { //runs if try block failed
         std::cerr << "Error: " << e.what() << std::endl; //prints error message
@@ -376,4 +413,4 @@ int main() { //func main that runs when program is executed
     } //ends catch block
 
     return 0; //default return value for main
-} //ends main
\ No newline at end of file
+} //ends main
@@ -0,0 +1,110 @@
+/*
+Name of Program: EECS 348 Lab 9 binary format test
+Description: Checks that binary matrix files round trip and that corrupt headers are rejected with a format error
+Input: None, writes temporary files in the working directory
+Output: One line per failing case on stderr, exit code 0 if every case passes
+Collaborators: None
+Sources: None
+Author: Oscar Ohly
+Creation date: 04/07/2025
+*/
+#include <cstdio> //gets file removal
+#include <cstring> //gets byte copies
+#include <fstream> //gets file reading and writing
+#include <functional> //gets header edit callbacks
+#include <iostream> //gets standard C++ library
+#include <iterator> //gets stream iterators for reading whole files
+#include <string> //gets string class
+#include <vector> //gets vectors
+#include "matrix.h" //gets Matrix class and matrix operations
+
+const std::string validName = "binary_test_valid.bin"; //well-formed file every corrupt case starts from
+const std::string corruptName = "binary_test_corrupt.bin"; //file rewritten for each corrupt case
+
+std::vector<char> readBytes(const std::string& filename) { //function returns every byte of a file
+    std::ifstream file(filename, std::ios::binary); //opens file
+    return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()); //reads whole file
+} //ends function
+
+void writeBytes(const std::string& filename, const std::vector<char>& bytes) { //function replaces a file with bytes
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc); //opens file
+    file.write(bytes.data(), static_cast<std::streamsize>(bytes.size())); //writes bytes
+} //ends function
+
+bool checkRejected(const std::string& name, const std::function<void(BinaryMatrixHeader&, std::vector<char>&)>& corrupt) { //function corrupts the valid file and checks that loading and verifying both fail with a format error
+    std::vector<char> bytes = readBytes(validName); //valid file
+    BinaryMatrixHeader header; //header of valid file
+    std::memcpy(&header, bytes.data(), sizeof(header)); //copies header out
+    corrupt(header, bytes); //damages header or bytes
+    std::memcpy(bytes.data(), &header, sizeof(header)); //writes header back
+    writeBytes(corruptName, bytes); //writes damaged file
+    for (int attempt = 0; attempt < 2; ++attempt) { //runs once for loading and once for verifying
+        try { //block runs if it doesn't error
+            if (attempt == 0) { //runs for loading
+                Matrix<double> matrix1, matrix2; //destination matrices
+                loadMatricesFromFile(corruptName, matrix1, matrix2); //should throw
+            } else { //runs for verifying
+                verifyBinaryMatrixFile(MappedFile(corruptName)); //should throw
+            } //ends if statement
+            std::cerr << "FAIL " << name << ": " << (attempt == 0 ? "load" : "verify") << " accepted a corrupt file\n"; //prints failing case
+            return false; //corrupt file was accepted
+        } catch (const std::runtime_error&) { //runs for the expected format error
+        } catch (const std::exception& e) { //runs for any other error, such as bad_alloc from an unchecked size
+            std::cerr << "FAIL " << name << ": " << (attempt == 0 ? "load" : "verify") << " threw " << e.what() << " instead of a format error\n"; //prints failing case
+            return false; //wrong kind of error
+        } //ends catch block
+    } //ends for loop
+    return true; //both paths rejected file
+} //ends function
+
+int main() { //func main that runs when program is executed
+    size_t failures = 0; //number of failing cases
+    Matrix<double> matrix1(5), matrix2(5); //small matrices, rows padded to a cache line
+    for (size_t i = 0; i < 5; ++i) { //runs for size of matrix
+        for (size_t j = 0; j < 5; ++j) { //runs for size of matrix
+            matrix1(i, j) = double(i * 5 + j) / 4; //element of first matrix
+            matrix2(i, j) = -double(i + j); //element of second matrix
+        } //ends for loop
+    } //ends for loop
+    matrix1.swapRows(0, 3); //rows out of physical order must be written in logical order
+    writeBinaryMatrixFile<double>(validName, {&matrix1, &matrix2}); //writes valid file with checksum
+
+    Matrix<double> loaded1, loaded2; //matrices read back
+    loadMatricesFromFile(validName, loaded1, loaded2); //wraps or copies file
+    for (size_t i = 0; i < 5; ++i) { //runs for size of matrix
+        for (size_t j = 0; j < 5; ++j) { //runs for size of matrix
+            if (loaded1(i, j) != matrix1(i, j) || loaded2(i, j) != matrix2(i, j)) { //runs if an element did not round trip
+                std::cerr << "FAIL round trip at (" << i << ", " << j << ")\n"; //prints failing case
+                ++failures; //counts failure
+            } //ends if statement
+        } //ends for loop
+    } //ends for loop
+    if (!verifyBinaryMatrixFile(MappedFile(validName))) { //runs if checksum of a fresh file does not match
+        std::cerr << "FAIL checksum of valid file\n"; //prints failing case
+        ++failures; //counts failure
+    } //ends if statement
+
+    failures += !checkRejected("data offset 0", [](BinaryMatrixHeader& h, std::vector<char>&) { h.dataOffset = 0; }); //header would load as elements
+    failures += !checkRejected("unaligned data offset", [](BinaryMatrixHeader& h, std::vector<char>&) { h.dataOffset = 72; }); //rows would be misaligned
+    failures += !checkRejected("data offset past end", [](BinaryMatrixHeader& h, std::vector<char>& b) { h.dataOffset = (b.size() / 64 + 1) * 64; }); //data starts beyond file
+    failures += !checkRejected("size overflow", [](BinaryMatrixHeader& h, std::vector<char>&) { h.size = h.stride = uint64_t(1) << 31; h.matrixBytes = 0; }); //size * stride * 8 wraps to 0
+    failures += !checkRejected("row overflow", [](BinaryMatrixHeader& h, std::vector<char>&) { h.size = 1; h.stride = uint64_t(1) << 61; h.matrixBytes = 0; }); //stride * 8 wraps to 0
+    failures += !checkRejected("count overflow", [](BinaryMatrixHeader& h, std::vector<char>&) { h.matrixCount = 0xffffffffu; h.size = h.stride = uint64_t(1) << 16; h.matrixBytes = uint64_t(1) << 35; }); //count * matrixBytes wraps to 0
+    failures += !checkRejected("matrix bytes mismatch", [](BinaryMatrixHeader& h, std::vector<char>&) { h.matrixBytes += 64; }); //second matrix would start mid-row
+    failures += !checkRejected("stride below size", [](BinaryMatrixHeader& h, std::vector<char>&) { h.stride = h.size - 1; h.matrixBytes = h.size * h.stride * sizeof(double); }); //rows would overlap
+    failures += !checkRejected("truncated", [](BinaryMatrixHeader&, std::vector<char>& b) { b.resize(b.size() - 8); }); //last element missing
+    failures += !checkRejected("bad version", [](BinaryMatrixHeader& h, std::vector<char>&) { h.version = 2; }); //unknown version
+
+    std::vector<char> bytes = readBytes(validName); //valid file
+    bytes.back() ^= 1; //flips one bit of the last element
+    writeBytes(corruptName, bytes); //writes damaged data
+    if (verifyBinaryMatrixFile(MappedFile(corruptName))) { //runs if checksum missed the damage
+        std::cerr << "FAIL checksum missed a flipped bit\n"; //prints failing case
+        ++failures; //counts failure
+    } //ends if statement
+
+    std::remove(validName.c_str()); //removes temporary file
+    std::remove(corruptName.c_str()); //removes temporary file
+    std::cout << (failures == 0 ? "all cases passed\n" : "some cases failed\n"); //prints summary
+    return failures == 0 ? 0 : 1; //nonzero exit if any case failed
+} //ends main
@@ -0,0 +1,114 @@
+/*
+Name of Program: EECS 348 Lab 9 multiply test
+Description: Checks the blocked multiply behind operator* against the naive i-j-k multiply for int, float and double
+Input: MATRIX_SIMD in the environment picks the kernel under test (portable, avx2, or unset for the best one)
+Output: One line per failing case on stderr, exit code 0 if every case passes
+Collaborators: None
+Sources: None
+Author: Oscar Ohly
+Creation date: 04/07/2025
+*/
+#include <algorithm> //gets max
+#include <cmath> //gets absolute values
+#include <iostream> //gets standard C++ library
+#include <limits> //gets machine epsilon
+#include <random> //gets random number generation
+#include <string> //gets string class
+#include <vector> //gets vectors
+#include "matrix.h" //gets Matrix class and matrix operations
+
+template <typename T> //declares template for a generic type T
+Matrix<T> randomMatrix(size_t size, std::mt19937& generator) { //function fills a matrix with small values, integers stay exact and floats stay near 1
+    Matrix<T> matrix(size); //new matrix containing values of type T
+    std::uniform_int_distribution<int> values(-50, 50); //element values
+    for (size_t i = 0; i < size; ++i) { //runs for size of matrix
+        for (size_t j = 0; j < size; ++j) { //runs for size of matrix
+            matrix(i, j) = std::is_integral<T>::value ? T(values(generator)) : T(values(generator)) / T(37); //element i,j
+        } //ends for loop
+    } //ends for loop
+    return matrix; //returns filled matrix
+} //ends function
+
+template <typename T> //declares template for a generic type T
+Matrix<T> absolute(const Matrix<T>& matrix) { //function returns |matrix| element by element, used to bound rounding error
+    Matrix<T> result(matrix.getSize()); //new matrix containing values of type T
+    for (size_t i = 0; i < matrix.getSize(); ++i) { //runs for size of matrix
+        for (size_t j = 0; j < matrix.getSize(); ++j) { //runs for size of matrix
+            result(i, j) = std::abs(matrix(i, j)); //absolute value of element
+        } //ends for loop
+    } //ends for loop
+    return result; //returns absolute matrix
+} //ends function
+
+template <typename T> //declares template for a generic type T
+T maxAbsolute(const Matrix<T>& matrix) { //function returns the largest |element|
+    T largest = T(); //largest so far
+    for (size_t i = 0; i < matrix.getSize(); ++i) { //runs for size of matrix
+        for (size_t j = 0; j < matrix.getSize(); ++j) { //runs for size of matrix
+            largest = std::max<T>(largest, std::abs(matrix(i, j))); //keeps larger value
+        } //ends for loop
+    } //ends for loop
+    return largest; //returns largest value
+} //ends function
+
+double strassenFactor(size_t size) { //function returns the Higham factor 12^levels (n0^2 + 5 n0) for the active Strassen cutoff, 0 if the blocked kernel is used
+    if (getMultiplyMode() != MultiplyMode::Strassen || size <= getStrassenCutoff()) { //runs if this product does not recurse
+        return 0; //no Strassen error term
+    } //ends if statement
+    double factor = 1; //12 per level of recursion
+    size_t leaf = size; //size of the blocked products at the bottom
+    while (leaf > getStrassenCutoff()) { //runs for each level, odd sizes peel one row and column first
+        leaf /= 2; //halves size
+        factor *= 12; //error growth of one level
+    } //ends while loop
+    return factor * double(leaf * leaf + 5 * leaf); //bound factor from README.md
+} //ends function
+
+template <typename T> //declares template for a generic type T
+bool checkProduct(const std::string& name, size_t size, bool permuted, std::mt19937& generator) { //function compares operator* with multiplyNaive for one case
+    Matrix<T> matrix1 = randomMatrix<T>(size, generator); //left factor
+    Matrix<T> matrix2 = randomMatrix<T>(size, generator); //right factor
+    if (permuted && size > 1) { //runs if operands should have rows out of physical order
+        matrix1.swapRows(0, size - 1); //permutes left factor
+        matrix2.swapRows(0, size / 2); //permutes right factor
+    } //ends if statement
+    const Matrix<T> blocked = matrix1 * matrix2; //product under test
+    const Matrix<T> naive = matrix1.multiplyNaive(matrix2); //reference product
+    const Matrix<T> bound = absolute(matrix1).multiplyNaive(absolute(matrix2)); //|A| |B|, scales the error bound of each element
+    const T unitRoundoff = std::numeric_limits<T>::epsilon() / 2; //u, half of machine epsilon, zero for int
+    const T strassenTolerance = T(strassenFactor(size)) * unitRoundoff * maxAbsolute(matrix1) * maxAbsolute(matrix2); //extra error allowed in Strassen mode, zero for int and for the blocked kernel
+    for (size_t i = 0; i < size; ++i) { //runs for size of matrix
+        for (size_t j = 0; j < size; ++j) { //runs for size of matrix
+            const T tolerance = T(2 * size) * unitRoundoff * bound(i, j) + strassenTolerance; //each blocked sum is within size * u * (|A| |B|)ij of the exact value, so they differ by at most 2 * size * u * (|A| |B|)ij
+            if (std::abs(blocked(i, j) - naive(i, j)) > tolerance) { //runs if element is outside tolerance
+                std::cerr << "FAIL " << name << " size " << size << (permuted ? " permuted" : "") << " at (" << i << ", " << j << "): " << blocked(i, j) << " != " << naive(i, j) << "\n"; //prints failing case
+                return false; //stops at first bad element
+            } //ends if statement
+        } //ends for loop
+    } //ends for loop
+    return true; //every element matches
+} //ends function
+
+int main() { //func main that runs when program is executed
+    const char* levels[] = {"portable", "avx2", "avx512"}; //names of instruction sets
+    std::cout << "kernel: " << levels[static_cast<int>(activeSimdLevel())] << "\n"; //prints which kernel is being tested
+    if (getMultiplyMode() == MultiplyMode::Strassen) { //runs if MATRIX_MULTIPLY=strassen
+        std::cout << "strassen cutoff: " << getStrassenCutoff() << "\n"; //prints cutoff being tested
+    } //ends if statement
+    std::mt19937 generator(348); //fixed seed so failures repeat
+    std::vector<size_t> sizes = {1, 15, 16, 17, 63, 64, 65, 255, 256, 257, 513}; //both sides of the tiny path and of the register and panel edges
+    if (getMultiplyMode() == MultiplyMode::Strassen) { //runs if Strassen is being tested
+        const size_t cutoff = getStrassenCutoff(); //size at which recursion stops
+        sizes.insert(sizes.end(), {cutoff - 1, cutoff, cutoff + 1, 2 * cutoff, 2 * cutoff + 1, 4 * cutoff + 3}); //both sides of the cutoff, one even level, and odd sizes that peel at every level
+    } //ends if statement
+    size_t failures = 0; //number of failing cases
+    for (size_t size : sizes) { //runs for each size
+        for (bool permuted : {false, true}) { //runs with rows in order and permuted
+            failures += !checkProduct<int>("int", size, permuted, generator); //int must be exact
+            failures += !checkProduct<float>("float", size, permuted, generator); //float within tolerance
+            failures += !checkProduct<double>("double", size, permuted, generator); //double within tolerance
+        } //ends for loop
+    } //ends for loop
+    std::cout << (failures == 0 ? "all cases passed\n" : "some cases failed\n"); //prints summary
+    return failures == 0 ? 0 : 1; //nonzero exit if any case failed
+} //ends main
@@ -0,0 +1,97 @@
+/*
+Name of Program: EECS 348 Lab 9 loader test
+Description: Checks that the memory-mapped parallel loader reads text files exactly as the iostream loader does
+Input: Path of matrixfile.txt as the first argument, writes temporary files in the working directory
+Output: One line per failing case on stderr, exit code 0 if every case passes
+Collaborators: None
+Sources: None
+Author: Oscar Ohly
+Creation date: 04/07/2025
+*/
+#include <cstdio> //gets file removal
+#include <fstream> //gets file writing
+#include <iostream> //gets standard C++ library
+#include <random> //gets random number generation
+#include <sstream> //gets string streams for building files
+#include <string> //gets string class
+#include "matrix.h" //gets Matrix class and matrix operations
+
+const std::string tempName = "loader_test_input.txt"; //file rewritten for each generated case
+
+template <typename T> //declares template for a generic type T
+bool compareLoaders(const std::string& name, const std::string& filename) { //function loads a file through both loaders and compares every element
+    Matrix<T> stream1, stream2, mapped1, mapped2; //matrices from each loader
+    loadMatricesFromStream(filename, stream1, stream2); //iostream reference
+    loadMatricesFromFile(filename, mapped1, mapped2); //mmap and from_chars, in parallel chunks for large files
+    if (stream1.getSize() != mapped1.getSize() || stream2.getSize() != mapped2.getSize()) { //runs if sizes differ
+        std::cerr << "FAIL " << name << ": sizes differ\n"; //prints failing case
+        return false; //case failed
+    } //ends if statement
+    for (size_t i = 0; i < stream1.getSize(); ++i) { //runs for size of matrix
+        for (size_t j = 0; j < stream1.getSize(); ++j) { //runs for size of matrix
+            if (stream1(i, j) != mapped1(i, j) || stream2(i, j) != mapped2(i, j)) { //runs if either matrix differs, both parsers round correctly so doubles must match exactly
+                std::cerr << "FAIL " << name << " at (" << i << ", " << j << "): " << stream1(i, j) << "/" << stream2(i, j) << " != " << mapped1(i, j) << "/" << mapped2(i, j) << "\n"; //prints failing case
+                return false; //stops at first bad element
+            } //ends if statement
+        } //ends for loop
+    } //ends for loop
+    return true; //every element matches
+} //ends function
+
+std::string generateFile(size_t size, int typeFlag, const std::string& newline, std::mt19937& generator) { //function builds a text matrix file with mixed number spellings
+    std::uniform_int_distribution<int> values(-99999, 99999); //integer part, varying lengths move chunk boundaries around
+    std::uniform_int_distribution<int> style(0, 5); //how each number is spelled
+    std::ostringstream text; //file contents
+    text << size << ' ' << typeFlag << newline; //header line
+    for (size_t m = 0; m < 2; ++m) { //runs for each matrix
+        for (size_t i = 0; i < size; ++i) { //runs for size of matrix
+            for (size_t j = 0; j < size; ++j) { //runs for size of matrix
+                const int value = values(generator); //next value
+                const int spelling = style(generator); //spelling of value
+                text << (j == 0 ? "" : spelling == 5 ? "\t" : " "); //tab or space between values
+                if (spelling == 0 && value >= 0) { //runs for some non-negative values
+                    text << '+'; //leading plus, accepted by >> but not by from_chars
+                } //ends if statement
+                if (typeFlag == 0) { //runs for int files
+                    text << value; //integer
+                } else if (spelling == 1) { //runs for some double values
+                    text << value << "e-3"; //scientific notation
+                } else if (spelling == 2) { //runs for some double values
+                    text << value << '.' << (static_cast<unsigned>(value) * 2654435761u % 1000000); //many fraction digits
+                } else { //runs for the remaining double values
+                    text << value / 100.0; //plain decimal
+                } //ends if statement
+            } //ends for loop
+            text << newline; //ends row
+        } //ends for loop
+    } //ends for loop
+    return text.str(); //returns contents
+} //ends function
+
+void writeFile(const std::string& filename, const std::string& text) { //function replaces a file with text
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc); //binary mode so CRLF is written as given
+    file << text; //writes contents
+} //ends function
+
+int main(int argc, char* argv[]) { //func main that runs when program is executed
+    size_t failures = 0; //number of failing cases
+    if (argc > 1) { //runs if the sample file was given
+        failures += !compareLoaders<double>("matrixfile.txt", argv[1]); //sample file in the repository
+    } //ends if statement
+    std::mt19937 generator(348); //fixed seed so failures repeat
+    for (size_t threads : {1, 3, 8}) { //thread counts change how large files are split into chunks
+        setMatrixThreadCount(threads); //sets chunk count for the next loads
+        for (const char* newline : {"\n", "\r\n"}) { //LF and CRLF line endings
+            const std::string ending = newline[0] == '\r' ? " crlf" : " lf"; //name of line ending
+            for (size_t size : {4, 300}) { //small file parsed in one chunk, and a file over 1 MiB parsed in many
+                writeFile(tempName, generateFile(size, 0, newline, generator)); //int file
+                failures += !compareLoaders<int>("int " + std::to_string(size) + ending + " threads " + std::to_string(threads), tempName); //compares int loaders
+                writeFile(tempName, generateFile(size, 1, newline, generator)); //double file
+                failures += !compareLoaders<double>("double " + std::to_string(size) + ending + " threads " + std::to_string(threads), tempName); //compares double loaders
+            } //ends for loop
+        } //ends for loop
+    } //ends for loop
+    std::remove(tempName.c_str()); //removes temporary file
+    std::cout << (failures == 0 ? "all cases passed\n" : "some cases failed\n"); //prints summary
+    return failures == 0 ? 0 : 1; //nonzero exit if any case failed
+} //ends main
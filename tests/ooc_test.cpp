@@ -0,0 +1,76 @@
+/*
+Name of Program: EECS 348 Lab 9 out-of-core multiply test
+Description: Checks that the streaming out-of-core multiply writes exactly the in-memory product
+Input: None, writes temporary files in the working directory
+Output: One line per failing case on stderr, exit code 0 if every case passes
+Collaborators: None
+Sources: None
+Author: Oscar Ohly
+Creation date: 04/07/2025
+*/
+#include <cstdio> //gets file removal
+#include <cstring> //gets byte comparison
+#include <iostream> //gets standard C++ library
+#include <random> //gets random number generation
+#include <string> //gets string class
+#include "matrix.h" //gets Matrix class and matrix operations
+
+const std::string inputName = "ooc_test_input.bin"; //two-matrix input file
+const std::string outputName = "ooc_test_output.bin"; //product file
+
+template <typename T> //declares template for a generic type T
+bool checkOutOfCore(const std::string& name, size_t size, size_t budget, std::mt19937& generator) { //function compares the out-of-core product of random matrices with operator*
+    std::uniform_int_distribution<int> values(-50, 50); //element values
+    Matrix<T> matrix1(size), matrix2(size); //factors
+    for (size_t i = 0; i < size; ++i) { //runs for size of matrix
+        for (size_t j = 0; j < size; ++j) { //runs for size of matrix
+            matrix1(i, j) = std::is_integral<T>::value ? T(values(generator)) : T(values(generator)) / T(7); //element of first matrix
+            matrix2(i, j) = std::is_integral<T>::value ? T(values(generator)) : T(values(generator)) / T(3); //element of second matrix
+        } //ends for loop
+    } //ends for loop
+    writeBinaryMatrixFile<T>(inputName, {&matrix1, &matrix2}); //writes input
+    multiplyFileOutOfCore(inputName, outputName, budget); //streams product to disk
+    const Matrix<T> expected = matrix1 * matrix2; //in-memory product
+
+    const MappedFile output(outputName); //product file
+    const BinaryMatrixHeader header = readBinaryMatrixHeader(output); //validated header
+    const size_t tile = outOfCoreTileSize(size, sizeof(T), budget); //tile edge the budget allows
+    std::string problem; //description of first failure, empty if none
+    if (header.matrixCount != 1 || header.size != size || header.elementType != binaryElementType<T>()) { //runs if header describes something else
+        problem = "wrong header"; //records failure
+    } else if (!verifyBinaryMatrixFile(output)) { //runs if checksum does not match data
+        problem = "checksum mismatch"; //records failure
+    } //ends if statement
+    for (size_t i = 0; i < size && problem.empty(); ++i) { //runs for each row until a mismatch
+        const char* row = output.begin() + header.dataOffset + i * header.stride * sizeof(T); //row i in file
+        if (std::memcmp(row, expected.rowData(i), size * sizeof(T)) != 0) { //runs if row differs in any bit
+            problem = "row " + std::to_string(i) + " differs from operator*"; //records failure
+        } //ends if statement
+    } //ends for loop
+    if (!problem.empty()) { //runs if case failed
+        std::cerr << "FAIL " << name << " size " << size << " tile " << tile << ": " << problem << "\n"; //prints failing case
+        return false; //case failed
+    } //ends if statement
+    return true; //product matches bit for bit
+} //ends function
+
+int main() { //func main that runs when program is executed
+    std::mt19937 generator(348); //fixed seed so failures repeat
+    const size_t budget = 3 << 20; //3 MiB, forces 256 x 256 tiles
+    size_t failures = 0; //number of failing cases
+    for (size_t size : {0, 5, 16, 17, 256, 512, 600}) { //tiny path, one tile, and several tiles with and without a partial last tile
+        failures += !checkOutOfCore<int>("int", size, budget, generator); //int must match exactly
+        failures += !checkOutOfCore<double>("double", size, budget, generator); //double must match bit for bit too, same summation order
+    } //ends for loop
+    failures += !checkOutOfCore<double>("double, one tile", 600, 64 << 20, generator); //budget large enough for a single tile
+    try { //block runs if it doesn't error
+        multiplyFileOutOfCore(inputName, outputName, 1 << 10); //budget below six panels
+        std::cerr << "FAIL tiny budget was accepted\n"; //prints failing case
+        ++failures; //counts failure
+    } catch (const std::invalid_argument&) { //runs for the expected error
+    } //ends catch block
+    std::remove(inputName.c_str()); //removes temporary file
+    std::remove(outputName.c_str()); //removes temporary file
+    std::cout << (failures == 0 ? "all cases passed\n" : "some cases failed\n"); //prints summary
+    return failures == 0 ? 0 : 1; //nonzero exit if any case failed
+} //ends main
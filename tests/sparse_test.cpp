@@ -0,0 +1,145 @@
+/*
+Name of Program: EECS 348 Lab 9 sparse matrix test
+Description: Checks SparseMatrix arithmetic, edits and the sparse file format against the dense Matrix
+Input: None, writes a temporary file in the working directory
+Output: One line per failing case on stderr, exit code 0 if every case passes
+Collaborators: None
+Sources: None
+Author: Oscar Ohly
+Creation date: 04/07/2025
+*/
+#include <cstdio> //gets file removal
+#include <fstream> //gets file writing
+#include <iostream> //gets standard C++ library
+#include <random> //gets random number generation
+#include <string> //gets string class
+#include "matrix.h" //gets Matrix class and matrix operations
+
+const std::string tempName = "sparse_test_input.txt"; //sparse text file
+
+template <typename T> //declares template for a generic type T
+Matrix<T> randomSparse(size_t size, double density, std::mt19937& generator) { //function returns a dense matrix with about density of its elements nonzero, values +-1 and +-2 so products often cancel
+    Matrix<T> matrix(size); //zeroed matrix
+    std::bernoulli_distribution present(density); //whether an element is nonzero
+    std::uniform_int_distribution<int> values(-2, 2); //nonzero values
+    for (size_t i = 0; i < size; ++i) { //runs for size of matrix
+        for (size_t j = 0; j < size; ++j) { //runs for size of matrix
+            if (present(generator)) { //runs for nonzero elements
+                const int value = values(generator); //value, redrawn if zero
+                matrix(i, j) = T(value == 0 ? 1 : value); //element i,j
+            } //ends if statement
+        } //ends for loop
+    } //ends for loop
+    return matrix; //returns matrix
+} //ends function
+
+template <typename T> //declares template for a generic type T
+size_t countNonZeros(const Matrix<T>& matrix) { //function counts nonzero elements of a dense matrix
+    size_t count = 0; //nonzero elements so far
+    for (size_t i = 0; i < matrix.getSize(); ++i) { //runs for size of matrix
+        for (size_t j = 0; j < matrix.getSize(); ++j) { //runs for size of matrix
+            count += matrix(i, j) != T(); //counts element if nonzero
+        } //ends for loop
+    } //ends for loop
+    return count; //returns count
+} //ends function
+
+template <typename T> //declares template for a generic type T
+bool sameAs(const std::string& name, const SparseMatrix<T>& sparse, const Matrix<T>& dense) { //function compares every element and the stored entry count, values are small integers so floating results are exact
+    bool same = sparse.getSize() == dense.getSize() && sparse.nonZeros() == countNonZeros(dense); //sizes and entry counts, zeros must not be stored
+    for (size_t i = 0; i < dense.getSize() && same; ++i) { //runs for size of matrix
+        for (size_t j = 0; j < dense.getSize() && same; ++j) { //runs for size of matrix
+            same = sparse.at(i, j) == dense(i, j); //compares element
+        } //ends for loop
+    } //ends for loop
+    if (!same) { //runs if matrices differ
+        std::cerr << "FAIL " << name << ": sparse result differs from dense (" << sparse.nonZeros() << " stored, " << countNonZeros(dense) << " nonzero)\n"; //prints failing case
+    } //ends if statement
+    return same; //returns result
+} //ends function
+
+template <typename T> //declares template for a generic type T
+bool sameAs(const std::string& name, const Matrix<T>& actual, const Matrix<T>& expected) { //function compares two dense matrices element by element
+    bool same = actual.getSize() == expected.getSize(); //sizes
+    for (size_t i = 0; i < expected.getSize() && same; ++i) { //runs for size of matrix
+        for (size_t j = 0; j < expected.getSize() && same; ++j) { //runs for size of matrix
+            same = actual(i, j) == expected(i, j); //compares element
+        } //ends for loop
+    } //ends for loop
+    if (!same) { //runs if matrices differ
+        std::cerr << "FAIL " << name << ": dense results differ\n"; //prints failing case
+    } //ends if statement
+    return same; //returns result
+} //ends function
+
+template <typename T> //declares template for a generic type T
+size_t checkSparse(const std::string& type, size_t size, double density, std::mt19937& generator) { //function checks every sparse operation on one pair of matrices, returns number of failures
+    const std::string name = type + " size " + std::to_string(size) + " density " + std::to_string(density); //case name
+    Matrix<T> dense1 = randomSparse<T>(size, density, generator); //first matrix
+    Matrix<T> dense2 = randomSparse<T>(size, density, generator); //second matrix
+    SparseMatrix<T> sparse1(dense1), sparse2(dense2); //compressed copies
+    size_t failures = 0; //failures in this case
+    failures += !sameAs(name + " convert", sparse1, dense1); //conversion from dense
+    failures += !sameAs(name + " toDense", sparse1.toDense(), dense1); //conversion back
+    failures += !sameAs(name + " +", sparse1 + sparse2, Matrix<T>(dense1 + dense2)); //sparse + sparse
+    failures += !sameAs(name + " * sparse", sparse1 * sparse2, dense1.multiplyNaive(dense2)); //sparse * sparse, cancelled entries must be dropped
+    failures += !sameAs(name + " * dense", sparse1 * dense2, dense1.multiplyNaive(dense2)); //sparse * dense
+    if (sparse1.sumMainDiagonal() != dense1.sumMainDiagonal() || sparse1.sumSecondaryDiagonal() != dense1.sumSecondaryDiagonal()) { //runs if diagonal sums differ
+        std::cerr << "FAIL " << name << " diagonal sums\n"; //prints failing case
+        ++failures; //counts failure
+    } //ends if statement
+    std::uniform_int_distribution<size_t> index(0, size - 1); //row or column index
+    std::uniform_int_distribution<int> values(-2, 2); //update values, zero erases an entry
+    for (size_t edit = 0; edit < 200; ++edit) { //runs for each edit, applied to both forms
+        const size_t a = index(generator), b = index(generator); //indices
+        if (edit % 3 == 0) { //runs for row swap
+            sparse1.swapRows(a, b); //swaps sparse rows
+            dense1.swapRows(a, b); //swaps dense rows
+        } else if (edit % 3 == 1) { //runs for column swap
+            sparse1.swapColumns(a, b); //swaps sparse cols
+            dense1.swapColumns(a, b); //swaps dense cols
+        } else { //runs for element update
+            const T value = T(values(generator)); //new value
+            sparse1.updateElement(a, b, value); //updates sparse element
+            dense1.updateElement(a, b, value); //updates dense element
+        } //ends if statement
+    } //ends for loop
+    failures += !sameAs(name + " edits", sparse1, dense1); //matrices after edits
+    return failures; //returns failures
+} //ends function
+
+size_t checkSparseFile() { //function loads the "n type sparse" format through the sparse and dense loaders, returns number of failures
+    std::ofstream file(tempName, std::ios::trunc); //writes file
+    file << "4 1 sparse\n" //header, double matrices
+         << "4\n0 0 1.5\n3 2 -2\n1 1 5\n3 2 4\n" //matrix1 entries, later duplicate wins
+         << "3\n2 3 7.25\n0 0 0\n1 2 +3\n"; //matrix2 entries, zero is dropped
+    file.close(); //flushes file
+    Matrix<double> expected1(4), expected2(4); //matrices the file describes
+    expected1(0, 0) = 1.5; expected1(1, 1) = 5; expected1(3, 2) = 4; //matrix1
+    expected2(2, 3) = 7.25; expected2(1, 2) = 3; //matrix2
+    SparseMatrix<double> sparse1, sparse2; //sparse loader output
+    Matrix<double> dense1, dense2; //dense loader output
+    loadMatricesFromFile(tempName, sparse1, sparse2); //keeps CSR form
+    loadMatricesFromFile(tempName, dense1, dense2); //expands to dense
+    std::remove(tempName.c_str()); //removes temporary file
+    size_t failures = 0; //failures in this case
+    failures += !sameAs("sparse file, sparse load 1", sparse1, expected1); //matrix1 through sparse loader
+    failures += !sameAs("sparse file, sparse load 2", sparse2, expected2); //matrix2 through sparse loader
+    failures += !sameAs("sparse file, dense load 1", dense1, expected1); //matrix1 through dense loader
+    failures += !sameAs("sparse file, dense load 2", dense2, expected2); //matrix2 through dense loader
+    return failures; //returns failures
+} //ends function
+
+int main() { //func main that runs when program is executed
+    std::mt19937 generator(348); //fixed seed so failures repeat
+    size_t failures = 0; //number of failing cases
+    for (size_t size : {1, 7, 64, 200}) { //small and multi-chunk sizes
+        for (double density : {0.02, 0.1, 0.5}) { //very sparse to half full, dense enough for many cancellations
+            failures += checkSparse<int>("int", size, density, generator); //int results
+            failures += checkSparse<double>("double", size, density, generator); //double results, exact for small integers
+        } //ends for loop
+    } //ends for loop
+    failures += checkSparseFile(); //file format
+    std::cout << (failures == 0 ? "all cases passed\n" : "some cases failed\n"); //prints summary
+    return failures == 0 ? 0 : 1; //nonzero exit if any case failed
+} //ends main
@@ -0,0 +1,95 @@
+/*
+Name of Program: EECS 348 Lab 9 tracked matrix test
+Description: Checks that TrackedMatrix keeps its sums and patched product equal to a fresh computation across random edits
+Input: None
+Output: One line per failing case on stderr, exit code 0 if every case passes
+Collaborators: None
+Sources: None
+Author: Oscar Ohly
+Creation date: 04/07/2025
+*/
+#include <algorithm> //gets max
+#include <cmath> //gets absolute values
+#include <iostream> //gets standard C++ library
+#include <random> //gets random number generation
+#include <string> //gets string class
+#include "matrix.h" //gets Matrix class and matrix operations
+
+template <typename T> //declares template for a generic type T
+T randomValue(std::mt19937& generator) { //function returns a small random value, exact for int
+    std::uniform_int_distribution<int> values(-20, 20); //element values
+    return std::is_integral<T>::value ? T(values(generator)) : T(values(generator)) / T(8); //value, a multiple of 1/8 for floating types
+} //ends function
+
+template <typename T> //declares template for a generic type T
+bool close(T actual, T expected, T tolerance) { //function checks one value, exact when tolerance is 0
+    return std::abs(actual - expected) <= tolerance; //compares within tolerance
+} //ends function
+
+template <typename T> //declares template for a generic type T
+bool checkTracked(const std::string& name, size_t size, size_t edits, size_t editsPerQuery, std::mt19937& generator) { //function applies random edits and compares every kept result with a fresh one after each query
+    Matrix<T> start(size), right(size); //initial A and B
+    for (size_t i = 0; i < size; ++i) { //runs for size of matrix
+        for (size_t j = 0; j < size; ++j) { //runs for size of matrix
+            start(i, j) = randomValue<T>(generator); //element of A
+            right(i, j) = randomValue<T>(generator); //element of B
+        } //ends for loop
+    } //ends for loop
+    TrackedMatrix<T> tracked(start); //matrix under test
+    tracked.setRightOperand(right); //B for product()
+    const T tolerance = std::is_integral<T>::value ? T(0) : T(1e-9); //values are multiples of 1/8, so double sums stay nearly exact
+    std::uniform_int_distribution<size_t> index(0, size - 1); //row or column index
+    std::uniform_int_distribution<int> kind(0, 5); //edit to apply, updates are most common
+    for (size_t edit = 1; edit <= edits; ++edit) { //runs for each edit
+        const int which = kind(generator); //edit kind
+        if (which == 0) { //runs for row swap
+            tracked.swapRows(index(generator), index(generator)); //swaps rows, possibly a row with itself
+        } else if (which == 1) { //runs for column swap
+            tracked.swapColumns(index(generator), index(generator)); //swaps cols, possibly a col with itself
+        } else { //runs for element update
+            tracked.updateElement(index(generator), index(generator), randomValue<T>(generator)); //replaces one element
+        } //ends if statement
+        if (edit % editsPerQuery != 0 && edit != edits) { //runs between queries
+            continue; //keeps queueing edits
+        } //ends if statement
+        const Matrix<T>& matrix = tracked.get(); //current A
+        const Matrix<T> expected = matrix * right; //fresh product
+        const Matrix<T>& product = tracked.product(); //patched or rebuilt product
+        std::string problem; //first mismatch, empty if none
+        for (size_t i = 0; i < size && problem.empty(); ++i) { //runs for size of matrix
+            T rowSum = T(), columnSum = T(); //fresh row and col sums
+            for (size_t j = 0; j < size; ++j) { //runs for size of matrix
+                rowSum += matrix(i, j); //adds to row sum
+                columnSum += matrix(j, i); //adds to col sum
+                if (!close(product(i, j), expected(i, j), tolerance)) { //runs if product element differs
+                    problem = "product at (" + std::to_string(i) + ", " + std::to_string(j) + ")"; //records failure
+                    break; //stops at first bad element
+                } //ends if statement
+            } //ends for loop
+            if (problem.empty() && (!close(tracked.rowSum(i), rowSum, tolerance) || !close(tracked.columnSum(i), columnSum, tolerance))) { //runs if a kept sum differs
+                problem = "row or column sum " + std::to_string(i); //records failure
+            } //ends if statement
+        } //ends for loop
+        if (problem.empty() && (!close(tracked.sumMainDiagonal(), matrix.sumMainDiagonal(), tolerance) || !close(tracked.sumSecondaryDiagonal(), matrix.sumSecondaryDiagonal(), tolerance))) { //runs if a diagonal sum differs
+            problem = "diagonal sum"; //records failure
+        } //ends if statement
+        if (!problem.empty()) { //runs if query found a mismatch
+            std::cerr << "FAIL " << name << " size " << size << " after edit " << edit << ": " << problem << "\n"; //prints failing case
+            return false; //case failed
+        } //ends if statement
+    } //ends for loop
+    return true; //every query matched
+} //ends function
+
+int main() { //func main that runs when program is executed
+    std::mt19937 generator(348); //fixed seed so failures repeat
+    size_t failures = 0; //number of failing cases
+    for (size_t size : {1, 2, 7, 40, 100}) { //tiny and blocked product sizes
+        for (size_t editsPerQuery : {1, 5, 1000}) { //queries after every edit, after small batches, and after enough edits to drop the cache
+            failures += !checkTracked<int>("int, query every " + std::to_string(editsPerQuery), size, 2000, editsPerQuery, generator); //int must match exactly
+            failures += !checkTracked<double>("double, query every " + std::to_string(editsPerQuery), size, 2000, editsPerQuery, generator); //double within a tiny tolerance
+        } //ends for loop
+    } //ends for loop
+    std::cout << (failures == 0 ? "all cases passed\n" : "some cases failed\n"); //prints summary
+    return failures == 0 ? 0 : 1; //nonzero exit if any case failed
+} //ends main